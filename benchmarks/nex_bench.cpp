@@ -0,0 +1,384 @@
+#include "nex_lexer.hpp"
+#include "nex_parser.hpp"
+#include "nex_resolver.hpp"
+#include "nex_optimizer.hpp"
+#include "nex_interpreter.hpp"
+#include "nex_heap.hpp"
+#include "nex_source.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Runs the scripts of the benchmark corpus through the
+// Lexer -> Parser -> Resolver -> Optimizer -> Interpreter pipeline and
+// prints, as JSON, the wall time and the heap allocations of every phase.
+//
+//   nex_bench [--repeat N] [script.nex ...]
+//
+// Without scripts, every .nex file of the benchmarks directory is run. Each
+// script runs N times (3 by default) and the fastest run of every phase is
+// reported. A script declares how many operations it performs with a
+// '// ops: <count>' comment line, ops_per_sec divides that count by the
+// interpreter time. Scripts without it count as one operation per run.
+// lex_mb_per_sec is the size of the script over the lexer time. The parse
+// phase includes the lexing the parser pulls as it goes.
+
+namespace {
+
+// Heap allocations made through operator new since the start of the process
+size_t g_allocations = 0;
+size_t g_allocatedBytes = 0;
+
+}
+
+void* operator new(size_t size)
+{
+    g_allocations++;
+    g_allocatedBytes += size;
+    if (auto p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace nex::bench {
+
+// Discards everything the scripts print
+class NullBuffer final : public std::streambuf
+{
+protected:
+    inline int_type overflow(int_type ch) override
+    {
+        return traits_type::not_eof(ch);
+    }
+
+    inline std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+        return count;
+    }
+};
+
+struct PhaseStats {
+    double wallMs = 0;
+    size_t allocations = 0;
+    size_t bytes = 0;
+};
+
+// Measures the section of code between its construction and stop()
+class PhaseTimer final
+{
+public:
+    PhaseTimer()
+        : m_start(std::chrono::steady_clock::now())
+        , m_allocations(g_allocations)
+        , m_bytes(g_allocatedBytes)
+    {}
+
+    inline PhaseStats stop() const
+    {
+        auto end = std::chrono::steady_clock::now();
+        PhaseStats stats;
+        stats.wallMs = std::chrono::duration<double, std::milli>(end - m_start).count();
+        stats.allocations = g_allocations - m_allocations;
+        stats.bytes = g_allocatedBytes - m_bytes;
+        return stats;
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+    size_t m_allocations;
+    size_t m_bytes;
+};
+
+enum Phase {
+    LEX,
+    PARSE,
+    RESOLVE,
+    OPTIMIZE,
+    INTERPRET,
+    PHASE_COUNT,
+};
+
+const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "lex",
+    "parse",
+    "resolve",
+    "optimize",
+    "interpret",
+};
+
+// Heap activity of one run, collections include the one closing the run
+struct HeapStats {
+    size_t bytesAllocated = 0;
+    size_t collections = 0;
+    size_t objectsCollected = 0;
+};
+
+struct RunResult {
+    PhaseStats phases[PHASE_COUNT];
+    size_t astBytes = 0;
+    HeapStats heap;
+    std::string error;
+};
+
+struct BenchResult {
+    std::string name;
+    std::string path;
+    size_t sourceBytes = 0;
+    size_t ops = 1;
+    size_t runs = 0;
+    PhaseStats phases[PHASE_COUNT];
+    size_t astBytes = 0;
+    HeapStats heap;
+    std::string error;
+};
+
+RunResult runScript(std::string_view source);
+
+RunResult runOnce(std::string_view source)
+{
+    auto before = Heap::stats();
+    auto result = runScript(source);
+
+    // Cycles left by the script would otherwise pile up across runs
+    Heap::collect();
+
+    const auto& after = Heap::stats();
+    result.heap.bytesAllocated = after.bytesAllocated - before.bytesAllocated;
+    result.heap.collections = after.collections - before.collections;
+    result.heap.objectsCollected = after.objectsCollected - before.objectsCollected;
+    return result;
+}
+
+RunResult runScript(std::string_view source)
+{
+    RunResult result;
+
+    // The parser pulls its tokens from the lexer, a separate pass over
+    // the tokens alone measures the lexer
+    PhaseTimer lexTimer;
+    Lexer lex(source);
+    while (lex.next().m_type != END_OF_FILE) {}
+    result.phases[LEX] = lexTimer.stop();
+    if (lex.error()) {
+        result.error = "lex error";
+        return result;
+    }
+
+    PhaseTimer parseTimer;
+    Arena arena;
+    Lexer parseLex(source);
+    Parser parser(parseLex, arena);
+    auto stmts = parser.parse();
+    result.phases[PARSE] = parseTimer.stop();
+    result.astBytes = arena.bytesUsed();
+    if (parser.error()) {
+        result.error = "parse error";
+        return result;
+    }
+
+    auto interp = std::make_shared<Interpreter>();
+
+    PhaseTimer resolveTimer;
+    auto resolver = std::make_shared<Resolver>(arena);
+    resolver->resolve(stmts);
+    result.phases[RESOLVE] = resolveTimer.stop();
+    if (resolver->error()) {
+        result.error = "resolve error";
+        return result;
+    }
+
+    PhaseTimer optimizeTimer;
+    stmts = Optimizer(arena).optimize(stmts);
+    result.phases[OPTIMIZE] = optimizeTimer.stop();
+
+    PhaseTimer interpretTimer;
+    interp->interpret(stmts);
+    result.phases[INTERPRET] = interpretTimer.stop();
+    if (interp->error()) {
+        result.error = "runtime error";
+    }
+
+    return result;
+}
+
+size_t declaredOps(std::string_view source)
+{
+    static const std::string OPS_PREFIX = "// ops:";
+
+    std::istringstream lines{ std::string(source) };
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, OPS_PREFIX.size(), OPS_PREFIX) == 0) {
+            auto ops = std::strtoull(line.c_str() + OPS_PREFIX.size(), nullptr, 10);
+            return ops > 0 ? ops : 1;
+        }
+    }
+    return 1;
+}
+
+BenchResult runBenchmark(const std::filesystem::path& path, size_t repeat)
+{
+    BenchResult bench;
+    bench.name = path.stem().string();
+    bench.path = path.string();
+
+    SourceFile file(path.c_str());
+    if (!file.isOpen()) {
+        bench.error = "cannot open file";
+        return bench;
+    }
+    auto source = file.text();
+    bench.sourceBytes = source.size();
+    bench.ops = declaredOps(source);
+
+    // Scripts print their results, keep them out of the report
+    NullBuffer null;
+    auto pOriginal = std::cout.rdbuf(&null);
+
+    for (size_t run = 0; run < repeat; run++) {
+        auto result = runOnce(source);
+        if (!result.error.empty()) {
+            bench.error = result.error;
+            break;
+        }
+
+        for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+            if (run == 0 || result.phases[phase].wallMs < bench.phases[phase].wallMs) {
+                bench.phases[phase] = result.phases[phase];
+            }
+        }
+        bench.astBytes = result.astBytes;
+        bench.heap = result.heap;
+        bench.runs++;
+    }
+
+    std::cout.rdbuf(pOriginal);
+    return bench;
+}
+
+std::string quote(const std::string& str)
+{
+    std::string out = "\"";
+    for (auto c : str) {
+        switch (c) {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        default:
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+void report(std::ostream& os, const std::vector<BenchResult>& benches, size_t repeat)
+{
+    os << "{\n";
+    os << "  \"repeat\": " << repeat << ",\n";
+    os << "  \"benchmarks\": [\n";
+    for (size_t idx = 0; idx < benches.size(); idx++) {
+        const auto& bench = benches[idx];
+        os << "    {\n";
+        os << "      \"name\": " << quote(bench.name) << ",\n";
+        os << "      \"file\": " << quote(bench.path) << ",\n";
+        if (!bench.error.empty()) {
+            os << "      \"error\": " << quote(bench.error) << "\n";
+        }
+        else {
+            double totalMs = 0;
+            os << "      \"runs\": " << bench.runs << ",\n";
+            os << "      \"phases\": {\n";
+            for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+                const auto& stats = bench.phases[phase];
+                totalMs += stats.wallMs;
+                os << "        " << quote(PHASE_NAMES[phase]) << ": { "
+                   << "\"wall_ms\": " << stats.wallMs << ", "
+                   << "\"allocations\": " << stats.allocations << ", "
+                   << "\"bytes\": " << stats.bytes << " }"
+                   << (phase + 1 < PHASE_COUNT ? ",\n" : "\n");
+            }
+            os << "      },\n";
+            os << "      \"ast_bytes\": " << bench.astBytes << ",\n";
+            os << "      \"heap\": { "
+               << "\"bytes_allocated\": " << bench.heap.bytesAllocated << ", "
+               << "\"collections\": " << bench.heap.collections << ", "
+               << "\"objects_collected\": " << bench.heap.objectsCollected << " },\n";
+            os << "      \"total_ms\": " << totalMs << ",\n";
+            os << "      \"ops\": " << bench.ops << ",\n";
+            double interpretSec = bench.phases[INTERPRET].wallMs / 1000.0;
+            os << "      \"ops_per_sec\": "
+               << (interpretSec > 0 ? bench.ops / interpretSec : 0.0) << ",\n";
+            double lexSec = bench.phases[LEX].wallMs / 1000.0;
+            os << "      \"source_bytes\": " << bench.sourceBytes << ",\n";
+            os << "      \"lex_mb_per_sec\": "
+               << (lexSec > 0 ? bench.sourceBytes / 1e6 / lexSec : 0.0) << "\n";
+        }
+        os << "    }" << (idx + 1 < benches.size() ? ",\n" : "\n");
+    }
+    os << "  ]\n";
+    os << "}" << std::endl;
+}
+
+}
+
+int main(int argc, const char** argv)
+{
+    using namespace nex::bench;
+
+    size_t repeat = 3;
+    std::vector<std::filesystem::path> paths;
+    for (int idx = 1; idx < argc; idx++) {
+        if (std::strcmp(argv[idx], "--repeat") == 0 && idx + 1 < argc) {
+            repeat = std::max(1L, std::strtol(argv[++idx], nullptr, 10));
+        }
+        else {
+            paths.emplace_back(argv[idx]);
+        }
+    }
+
+    if (paths.empty()) {
+        for (const auto& entry : std::filesystem::directory_iterator(NEX_BENCH_DIR)) {
+            if (entry.path().extension() == ".nex") {
+                paths.push_back(entry.path());
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+    }
+
+    std::vector<BenchResult> benches;
+    bool bFailed = false;
+    for (const auto& path : paths) {
+        benches.push_back(runBenchmark(path, repeat));
+        bFailed = bFailed || !benches.back().error.empty();
+    }
+
+    report(std::cout, benches, repeat);
+    return bFailed ? 1 : 0;
+}
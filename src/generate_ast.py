@@ -1,9 +1,9 @@
 import sys
 
 def define_ast_utils(writer, base_name, class_name, field_list):
-    # Pointer make wrapper
-    writer.write("inline std::shared_ptr<%s> make_%s(%s) {\n" % (base_name, class_name.lower(), field_list))
-    writer.write("    return std::make_shared<%s>(" % (class_name))
+    # Arena allocation wrapper
+    writer.write("inline %s* make_%s(Arena& arena, %s) {\n" % (class_name, class_name.lower(), field_list))
+    writer.write("    return arena.make<%s>(" % (class_name))
 
     fields = field_list.split(", ")
     for idx, field in enumerate(fields):
@@ -16,20 +16,21 @@ def define_ast_utils(writer, base_name, class_name, field_list):
     writer.write(");\n")
     writer.write("}\n\n")
 
-def define_visitor(writer, base_name, types):
+def define_visitor(writer, base_name, types, return_type):
     writer.write("class Visitor {\n")
     writer.write("public:\n")
     for t in types:
         type_name = t.split("|")[0].strip()
         writer.write(
-            "    virtual std::any visit%s%s(%s* %s) = 0;\n" % ( type_name,
-                                                                base_name,
-                                                                type_name,
-                                                                base_name.lower()))
+            "    virtual %s visit%s%s(%s* %s) = 0;\n" % ( return_type,
+                                                          type_name,
+                                                          base_name,
+                                                          type_name,
+                                                          base_name.lower()))
 
     writer.write("};\n\n")
 
-def define_type(writer, base_name, class_name, field_list):
+def define_type(writer, base_name, class_name, field_list, member_list, return_type):
     writer.write("struct %s : public %s {\n" % (class_name, base_name))
 
     # Constructor
@@ -41,34 +42,53 @@ def define_type(writer, base_name, class_name, field_list):
         name = field.split(" ")[1]
         writer.write("        m_%s(%s)" % (name, name))
 
-        if idx != len(fields) - 1:
+        if idx != len(fields) - 1 or member_list:
             writer.write(",")
         
         writer.write("\n")
 
+    # Members filled in at runtime, default constructed
+    members = member_list.split(", ") if member_list else []
+    for idx, member in enumerate(members):
+        name = member.split(" ")[1]
+        writer.write("        m_%s()" % (name))
+
+        if idx != len(members) - 1:
+            writer.write(",")
+
+        writer.write("\n")
+
     writer.write("    {}\n\n")
 
-    # Destructor
-    writer.write("    virtual ~%s() = default;\n" % (class_name))
+    # Nodes live in an Arena and have no destructor of their own, children
+    # are plain pointers and lists into the same arena
 
     # Visitor
-    writer.write("\n")
-    writer.write("    std::any accept(Visitor* visitor) {\n")
+    writer.write("    %s accept(Visitor* visitor) {\n" % (return_type))
     writer.write("        return visitor->visit%s%s(this);\n" % (class_name, base_name))
     writer.write("    }\n\n")
 
-    # Fields
+    # Fields. Children (pointers and lists) stay assignable so passes over
+    # the tree can replace subtrees in place
     for field in fields:
         field_type = field.split(" ")[0]
         name = field.split(" ")[1]
-        writer.write("    const %s m_%s;\n" % (field_type, name))
+        if field_type.endswith("*") or field_type.startswith("ArenaList"):
+            writer.write("    %s m_%s;\n" % (field_type, name))
+        else:
+            writer.write("    %s const m_%s;\n" % (field_type, name))
+
+    for member in members:
+        member_type = member.split(" ")[0]
+        name = member.split(" ")[1]
+        writer.write("    %s m_%s;\n" % (member_type, name))
 
     writer.write("};\n\n")
 
     define_ast_utils(writer, base_name, class_name, field_list)
 
 
-def define_ast(output_dir, base_name, types, dependencies):
+def define_ast(output_dir, base_name, return_type, types, dependencies):
     path = output_dir + "/nex_" + base_name.lower() + ".hpp"
 
     writer = open(path, "w", encoding="UTF-8")
@@ -78,10 +98,9 @@ def define_ast(output_dir, base_name, types, dependencies):
     writer.write("\n")
 
     for dep in dependencies:
-        writer.write("#include \"%s.hpp\"\n" % dep)
+        writer.write("#include \"nex_%s.hpp\"\n" % dep)
 
-    writer.write("#include <memory>\n")
-    writer.write("#include <vector>\n\n")
+    writer.write("\n")
 
     writer.write("namespace nex::ast::%s {\n" % base_name.lower())
 
@@ -91,16 +110,18 @@ def define_ast(output_dir, base_name, types, dependencies):
         writer.write("struct %s;\n" % name)
     writer.write("\n")
 
-    define_visitor(writer, base_name, types)
+    define_visitor(writer, base_name, types, return_type)
 
     writer.write("struct %s {\n" % base_name)
-    writer.write("    virtual std::any accept(Visitor* visitor) = 0;\n")
+    writer.write("    virtual %s accept(Visitor* visitor) = 0;\n" % (return_type))
     writer.write("};\n\n")
 
+    # Type spec: "Name | constructor fields [| runtime members]"
     for type in types:
         name = type.split("|")[0].strip()
         fields = type.split("|")[1].strip()
-        define_type(writer, base_name, name, fields)
+        members = type.split("|")[2].strip() if type.count("|") > 1 else ""
+        define_type(writer, base_name, name, fields, members, return_type)
 
     writer.write("}\n")
 
@@ -114,31 +135,31 @@ if __name__ == "__main__":
         exit(1)
     else:
         output_dir = sys.argv[1]
-        define_ast(output_dir, "Expr", [
-            "Assign     | Token name, std::shared_ptr<Expr> value",
-            "Binary     | std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right",
-            "Call       | std::shared_ptr<Expr> callee, Token paren, std::vector<std::shared_ptr<Expr>> arguments",
-            "Get        | std::shared_ptr<Expr> object, Token name",
-            "Set        | std::shared_ptr<Expr> object, Token name, std::shared_ptr<Expr> value",
-            "Super      | Token keyword, Token method",
-            "This       | Token keyword",
-            "Grouping   | std::shared_ptr<Expr> expression",
-            "Literal    | std::any value",
-            "Logical    | std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right",
-            "Unary      | Token op, std::shared_ptr<Expr> right",
-            "Comma      | std::vector<std::shared_ptr<Expr>> exprs, std::shared_ptr<Expr> last",
-            "Variable   | Token name",
+        define_ast(output_dir, "Expr", "Value", [
+            "Assign     | SlimToken name, Expr* value | Resolution resolution",
+            "Binary     | Expr* left, SlimToken op, Expr* right",
+            "Call       | Expr* callee, SlimToken paren, ArenaList<Expr*> arguments | InlineCache cache",
+            "Get        | Expr* object, SlimToken name | InlineCache cache",
+            "Set        | Expr* object, SlimToken name, Expr* value | InlineCache cache",
+            "Super      | SlimToken keyword, SlimToken method | Resolution resolution, Resolution thisResolution",
+            "This       | SlimToken keyword | Resolution resolution",
+            "Grouping   | Expr* expression",
+            "Literal    | Value value",
+            "Logical    | Expr* left, SlimToken op, Expr* right",
+            "Unary      | SlimToken op, Expr* right",
+            "Comma      | ArenaList<Expr*> exprs, Expr* last",
+            "Variable   | SlimToken name | Resolution resolution",
             "Input      | void* e",
-        ], ["token"])
-
-        define_ast(output_dir, "Stmt", [
-            "Block      | std::vector<std::shared_ptr<Stmt>> statements",
-            "Class      | Token name, std::shared_ptr<expr::Variable> superclass, std::vector<std::shared_ptr<Function>> methods, std::vector<std::shared_ptr<Let>> fields",
-            "Expression | std::shared_ptr<expr::Expr> e",
-            "Function   | Token name, std::vector<Token> params, std::vector<std::shared_ptr<Stmt>> body",
-            "If         | std::shared_ptr<expr::Expr> cond, std::shared_ptr<Stmt> thenBranch, std::shared_ptr<Stmt> elseBranch",
-            "Print      | std::shared_ptr<expr::Expr> e",
-            "Return     | Token keyword, std::shared_ptr<expr::Expr> value",
-            "Let        | Token name, std::shared_ptr<expr::Expr> init",
-            "While      | std::shared_ptr<expr::Expr> cond, std::shared_ptr<Stmt> body",
-        ], ["token", "expr",])
+        ], ["arena", "token", "value", "inline_cache", "resolution"])
+
+        define_ast(output_dir, "Stmt", "void", [
+            "Block      | ArenaList<Stmt*> statements",
+            "Class      | SlimToken name, expr::Variable* superclass, ArenaList<Function*> methods, ArenaList<Let*> fields | Resolution resolution, Resolution superResolution, ArenaList<Capture> fieldCaptures",
+            "Expression | expr::Expr* e",
+            "Function   | SlimToken name, ArenaList<SlimToken> params, ArenaList<Stmt*> body | Resolution resolution, ArenaList<Capture> captures, ArenaList<uint32_t> cells",
+            "If         | expr::Expr* cond, Stmt* thenBranch, Stmt* elseBranch",
+            "Print      | expr::Expr* e",
+            "Return     | SlimToken keyword, expr::Expr* value",
+            "Let        | SlimToken name, expr::Expr* init | Resolution resolution",
+            "While      | expr::Expr* cond, Stmt* body",
+        ], ["arena", "token", "expr", "resolution"])
@@ -1,86 +1,139 @@
 #include "nex_lexer.hpp"
 #include "nex_parser.hpp"
 #include "nex_resolver.hpp"
+#include "nex_optimizer.hpp"
 #include "nex_interpreter.hpp"
+#include "nex_vm.hpp"
+#include "nex_heap.hpp"
+#include "nex_source.hpp"
 
 #include <iostream>
-#include <fstream>
 #include <unistd.h>
-#include <sstream>
+#include <cstdlib>
+#include <cstring>
 #include <type_traits>
 
 using namespace nex::ast;
 
+static void printHeapStats()
+{
+    const auto& stats = nex::Heap::stats();
+    std::cerr << "heap: " << stats.bytesAllocated << " bytes allocated, "
+               << stats.bytesLive << " bytes in " << stats.objectsLive
+               << " live objects, " << stats.collections << " collections, "
+               << stats.objectsCollected << " objects collected" << std::endl;
+}
+
 int main(int argc, const char** argv)
 {
-    if (argc < 2) {
-        std::wcout << L"Nex Lang Version 0.1" << std::endl;
-        auto interp = std::make_shared<nex::Interpreter>();
-        while (true) {
-            std::wcout << "$ ";
-            std::wstring line;
-            std::getline(std::wcin, line);
+    // Execute on the bytecode VM instead of the tree-walking interpreter
+    bool bUseVM = false;
+    // Print the heap statistics when the program ends
+    bool bHeapStats = false;
+    nex::Heap::Config heapConfig;
+    const char* path = nullptr;
+    for (int idx = 1; idx < argc; idx++) {
+        if (std::strcmp(argv[idx], "--vm") == 0) {
+            bUseVM = true;
+        }
+        else if (std::strcmp(argv[idx], "--gc-stats") == 0) {
+            bHeapStats = true;
+        }
+        else if (std::strncmp(argv[idx], "--gc-threshold=", 15) == 0) {
+            heapConfig.initialThreshold = std::strtoull(argv[idx] + 15, nullptr, 10);
+        }
+        else if (std::strncmp(argv[idx], "--gc-growth=", 12) == 0) {
+            heapConfig.growthFactor = std::strtod(argv[idx] + 12, nullptr);
+        }
+        else {
+            path = argv[idx];
+        }
+    }
 
-            auto stream = std::wistringstream(line);
-            nex::Lexer lex(stream);
-            auto tokens = lex.scan();
+    nex::Heap::configure(heapConfig);
 
-            if (lex.error()) {
-                continue;
-            }
+    if (!path) {
+        std::cout << "Nex Lang Version 0.1" << std::endl;
+        auto interp = std::make_shared<nex::Interpreter>();
+        nex::VM vm;
+        // Functions and classes outlive the line that declared them, so the
+        // whole session shares one arena
+        nex::Arena arena;
+        while (true) {
+            std::cout << "$ ";
+            std::string line;
+            std::getline(std::cin, line);
 
-            nex::Parser parser(tokens);
+            nex::Lexer lex(line);
+            nex::Parser parser(lex, arena);
             auto stmts = parser.parse();
 
-            if (parser.error()) {
+            if (lex.error() || parser.error()) {
                 continue;
             }
 
-            auto resolver = std::make_shared<nex::Resolver>(interp);
+            auto resolver = std::make_shared<nex::Resolver>(arena);
             resolver->resolve(stmts);
 
             if (resolver->error()) {
                 exit(65);
             }
 
-            interp->interpret(stmts);
+            stmts = nex::Optimizer(arena).optimize(stmts);
+
+            if (bUseVM) {
+                vm.interpret(stmts);
+            }
+            else {
+                interp->interpret(stmts);
+            }
         }
 
         exit(0);
     }
 
-    std::wifstream src;
-    src.open(argv[1]);
+    nex::SourceFile src(path);
 
-    if (!src.is_open()) {
+    if (!src.isOpen()) {
         std::cout << "nexc: " << "error: no such file "
-            << argv[1] << std::endl;
+            << path << std::endl;
         exit(10);
     }
 
-    nex::Lexer lex(src);
-    auto tokens = lex.scan();
-
-    if (lex.error()) {
-        exit(65);
-    }
-
-    nex::Parser parser(tokens);
+    // The parser pulls the tokens from the lexer as it goes
+    nex::Lexer lex(src.text());
+    nex::Arena arena;
+    nex::Parser parser(lex, arena);
     auto stmts = parser.parse();
 
-    if (parser.error()) {
+    if (lex.error() || parser.error()) {
         exit(65);
     }
 
-    auto interp = std::make_shared<nex::Interpreter>();
-    auto resolver = std::make_shared<nex::Resolver>(interp);
+    auto resolver = std::make_shared<nex::Resolver>(arena);
     resolver->resolve(stmts);
 
     if (resolver->error()) {
         exit(65);
     }
 
-    interp->interpret(stmts);
+    stmts = nex::Optimizer(arena).optimize(stmts);
+
+    if (bUseVM) {
+        nex::VM vm;
+        vm.interpret(stmts);
+    }
+    else {
+        auto interp = std::make_shared<nex::Interpreter>();
+        interp->interpret(stmts);
+    }
+
+    // Reclaim the cycles the program left behind
+    nex::Heap::collect();
+
+    if (bHeapStats) {
+        printHeapStats();
+    }
 
     return 0;
 }
@@ -0,0 +1,164 @@
+#ifndef NEX_ARENA_HPP
+#define NEX_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nex {
+
+// Fixed size array living in an Arena
+template <typename T>
+class ArenaList final
+{
+public:
+    ArenaList()
+        : m_pData(nullptr)
+        , m_size(0)
+    {}
+
+    ArenaList(T* pData, size_t size)
+        : m_pData(pData)
+        , m_size(size)
+    {}
+
+    inline size_t size() const { return m_size; }
+    inline bool empty() const { return m_size == 0; }
+
+    inline const T* begin() const { return m_pData; }
+    inline const T* end() const { return m_pData + m_size; }
+
+    inline const T& operator[](size_t idx) const { return m_pData[idx]; }
+    inline const T& at(size_t idx) const { return m_pData[idx]; }
+
+    inline T& operator[](size_t idx) { return m_pData[idx]; }
+
+    // Forgets the elements past the first 'size', the memory stays in the arena
+    inline void shrink(size_t size)
+    {
+        if (size < m_size) {
+            m_size = size;
+        }
+    }
+
+private:
+    T* m_pData;
+    size_t m_size;
+};
+
+// Bump allocator for objects that share one lifetime, such as the AST of a
+// compilation. Objects are never freed one by one, everything goes away
+// with the arena. Only types with a non-trivial destructor are remembered
+// and destroyed, the rest is released with the memory blocks.
+class Arena final
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    Arena()
+        : m_blocks()
+        , m_pCursor(nullptr)
+        , m_pLimit(nullptr)
+        , m_bytesUsed(0)
+        , m_bytesReserved(0)
+        , m_destructors()
+    {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena()
+    {
+        for (auto it = m_destructors.rbegin(); it != m_destructors.rend(); ++it) {
+            it->pDestroy(it->pObject);
+        }
+    }
+
+    inline void* allocate(size_t size, size_t align)
+    {
+        auto address = reinterpret_cast<uintptr_t>(m_pCursor);
+        auto aligned = (address + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        if (!m_pCursor || aligned + size > reinterpret_cast<uintptr_t>(m_pLimit)) {
+            grow(size + align);
+            address = reinterpret_cast<uintptr_t>(m_pCursor);
+            aligned = (address + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+        }
+
+        m_pCursor = reinterpret_cast<uint8_t*>(aligned + size);
+        m_bytesUsed += size;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    template <typename T, typename ...Args>
+    T* make(Args&& ...args)
+    {
+        auto pObject = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            m_destructors.push_back({ pObject, [](void* p) { static_cast<T*>(p)->~T(); } });
+        }
+        return pObject;
+    }
+
+    template <typename T>
+    ArenaList<T> list(const std::vector<T>& items)
+    {
+        return copy<T>(items.begin(), items.size());
+    }
+
+    template <typename T>
+    ArenaList<T> list(std::initializer_list<T> items)
+    {
+        return copy<T>(items.begin(), items.size());
+    }
+
+    // Bytes handed out to objects, and bytes requested from the system
+    inline size_t bytesUsed() const { return m_bytesUsed; }
+    inline size_t bytesReserved() const { return m_bytesReserved; }
+
+private:
+    struct Destructor {
+        void* pObject;
+        void (*pDestroy)(void*);
+    };
+
+    template <typename T, typename It>
+    ArenaList<T> copy(It first, size_t size)
+    {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "ArenaList elements are never destroyed");
+        if (size == 0) {
+            return ArenaList<T>();
+        }
+
+        auto pData = static_cast<T*>(allocate(sizeof(T) * size, alignof(T)));
+        for (size_t idx = 0; idx < size; idx++, ++first) {
+            new (pData + idx) T(*first);
+        }
+        return ArenaList<T>(pData, size);
+    }
+
+    inline void grow(size_t minSize)
+    {
+        auto size = minSize > BLOCK_SIZE ? minSize : BLOCK_SIZE;
+        m_blocks.emplace_back(new uint8_t[size]);
+        m_pCursor = m_blocks.back().get();
+        m_pLimit = m_pCursor + size;
+        m_bytesReserved += size;
+    }
+
+    std::vector<std::unique_ptr<uint8_t[]>> m_blocks;
+    uint8_t* m_pCursor;
+    uint8_t* m_pLimit;
+    size_t m_bytesUsed;
+    size_t m_bytesReserved;
+    std::vector<Destructor> m_destructors;
+};
+
+}
+
+#endif
@@ -1,21 +1,72 @@
 #ifndef NEX_CALLABLE_HPP
 #define NEX_CALLABLE_HPP
 
-#include <any>
-#include <vector>
+#include "nex_heap.hpp"
+#include "nex_value.hpp"
+
+#include <cstddef>
+#include <string>
 
 namespace nex {
 class Interpreter;
 
-class NexCallable
+// Calls nested deeper than this are a "Stack overflow." runtime error, the
+// same in both engines. The interpreter recurses on the C++ stack for each
+// call, the limit leaves room for that in debug and sanitizer builds.
+constexpr size_t MAX_CALL_DEPTH = 1024;
+
+// The arguments of a call, a view of the slots they were evaluated into.
+// The interpreter evaluates them straight onto its value stack, after a
+// slot left for the receiver, and a function's frame starts on them. The
+// VM passes a view of its own stack to native functions.
+class Arguments final
+{
+public:
+    Arguments(Value* pData, size_t size)
+        : m_pData(pData)
+        , m_size(size)
+    {}
+
+    inline size_t size() const { return m_size; }
+    inline bool empty() const { return m_size == 0; }
+
+    inline Value* data() const { return m_pData; }
+    inline Value* begin() const { return m_pData; }
+    inline Value* end() const { return m_pData + m_size; }
+
+    inline Value& operator[](size_t idx) const { return m_pData[idx]; }
+
+private:
+    Value* m_pData;
+    size_t m_size;
+};
+
+class NexCallable : public HeapObject
 {
 public:
     virtual size_t arity() const = 0;
-    virtual std::any call(Interpreter* interp, std::vector<std::any> arguments) = 0;
-    virtual std::wstring to_string() const = 0;
-    virtual std::wstring name() const = 0;
+    virtual Value call(Interpreter* interp, Arguments arguments) = 0;
+    virtual std::string to_string() const = 0;
+    virtual std::string name() const = 0;
+
+    // Native functions hold no references
+    inline void trace(Tracer& tracer) override
+    {
+        (void) tracer;
+    }
+
+    inline void clear() override {}
 };
 
+inline Value::Value(NexCallable* pCallable)
+    : Value(ValueType::CALLABLE, pCallable)
+{}
+
+inline NexCallable* Value::asCallable() const
+{
+    return static_cast<NexCallable*>(m_as.pObject);
+}
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,40 @@
+#ifndef NEX_CELL_HPP
+#define NEX_CELL_HPP
+
+#include "nex_heap.hpp"
+#include "nex_value.hpp"
+
+namespace nex {
+
+// Box of a local variable a nested function captures. The frame slot of the
+// variable holds the Cell, and every closure that captured the variable
+// shares it, so they see each other's assignments after the frame is gone.
+class Cell final : public HeapObject
+{
+public:
+    explicit Cell(Value value)
+        : m_value(std::move(value))
+    {}
+
+    virtual ~Cell() = default;
+
+    inline void trace(Tracer& tracer) override
+    {
+        tracer.visit(m_value);
+    }
+
+    inline void clear() override
+    {
+        m_value = nullptr;
+    }
+
+    Value m_value;
+};
+
+inline Value::Value(Cell* pCell)
+    : Value(ValueType::CELL, pCell)
+{}
+
+}
+
+#endif
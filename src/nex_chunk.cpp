@@ -0,0 +1,112 @@
+#include "nex_chunk.hpp"
+#include "nex_vm_object.hpp"
+
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+
+namespace nex {
+
+std::string opcodeToStr(OpCode op)
+{
+    assert(op < OPCODE_NUM);
+#define EMIT_OPCODE(id, str) str,
+    const std::string opcodes[] = {
+        OPCODE_LIST
+#undef EMIT_OPCODE
+    };
+    return opcodes[op];
+}
+
+void Chunk::write(uint8_t byte, int line)
+{
+    m_code.push_back(byte);
+    m_lines.push_back(line);
+}
+
+size_t Chunk::addConstant(const Value& value)
+{
+    m_constants.push_back(value);
+    return m_constants.size() - 1;
+}
+
+void Chunk::disassemble(const std::string& name) const
+{
+    std::cout << "== " << name << " ==" << std::endl;
+    for (size_t offset = 0; offset < m_code.size();) {
+        offset = disassembleInstruction(offset);
+    }
+}
+
+size_t Chunk::disassembleInstruction(size_t offset) const
+{
+    auto readShort = [this](size_t at) {
+        return static_cast<uint16_t>((m_code[at] << 8) | m_code[at + 1]);
+    };
+
+    auto op = static_cast<OpCode>(m_code[offset]);
+    std::cout << std::setfill('0') << std::setw(4) << offset << " "
+               << std::setfill(' ') << std::setw(4) << m_lines[offset] << " "
+               << opcodeToStr(op);
+
+    switch (op) {
+    case OP_GET_LOCAL:
+    case OP_SET_LOCAL:
+    case OP_GET_UPVALUE:
+    case OP_SET_UPVALUE:
+    case OP_CALL:
+        std::cout << " " << static_cast<int>(m_code[offset + 1]) << std::endl;
+        return offset + 2;
+    case OP_GET_GLOBAL:
+    case OP_DEFINE_GLOBAL:
+    case OP_SET_GLOBAL:
+        std::cout << " " << readShort(offset + 1) << std::endl;
+        return offset + 3;
+    case OP_CONSTANT:
+    case OP_GET_PROPERTY:
+    case OP_SET_PROPERTY:
+    case OP_GET_SUPER:
+    case OP_CLASS:
+    case OP_METHOD:
+    case OP_DEFINE_FIELD:
+    {
+        auto constant = readShort(offset + 1);
+        std::cout << " " << constant << " '" << m_constants[constant].toString() << "'" << std::endl;
+        return offset + 3;
+    }
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+        std::cout << " -> " << offset + 3 + readShort(offset + 1) << std::endl;
+        return offset + 3;
+    case OP_LOOP:
+        std::cout << " -> " << offset + 3 - readShort(offset + 1) << std::endl;
+        return offset + 3;
+    case OP_INVOKE:
+    case OP_SUPER_INVOKE:
+    {
+        auto constant = readShort(offset + 1);
+        std::cout << " (" << static_cast<int>(m_code[offset + 3]) << " args) "
+                   << constant << " '" << m_constants[constant].toString() << "'" << std::endl;
+        return offset + 4;
+    }
+    case OP_CLOSURE:
+    {
+        auto constant = readShort(offset + 1);
+        auto& function = m_constants[constant];
+        std::cout << " " << constant << " " << function.toString() << std::endl;
+
+        offset += 3;
+        for (size_t idx = 0; idx < function.as<vm::Function>()->m_upvalueCount; idx++) {
+            bool bIsLocal = m_code[offset++];
+            int index = m_code[offset++];
+            std::cout << "          | " << (bIsLocal ? "local " : "upvalue ") << index << std::endl;
+        }
+        return offset;
+    }
+    default:
+        std::cout << std::endl;
+        return offset + 1;
+    }
+}
+
+}
@@ -0,0 +1,92 @@
+#ifndef NEX_CHUNK_HPP
+#define NEX_CHUNK_HPP
+
+#include "nex_value.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nex {
+
+// Bytecode instruction set (opcode and operand layout). Operands follow the
+// opcode in the code stream, 'short' operands are 16 bit big endian.
+#define OPCODE_LIST \
+    EMIT_OPCODE(OP_CONSTANT, "OP_CONSTANT")              /* short constant */ \
+    EMIT_OPCODE(OP_NIL, "OP_NIL") \
+    EMIT_OPCODE(OP_TRUE, "OP_TRUE") \
+    EMIT_OPCODE(OP_FALSE, "OP_FALSE") \
+    EMIT_OPCODE(OP_POP, "OP_POP") \
+    EMIT_OPCODE(OP_GET_LOCAL, "OP_GET_LOCAL")            /* byte slot */ \
+    EMIT_OPCODE(OP_SET_LOCAL, "OP_SET_LOCAL")            /* byte slot */ \
+    EMIT_OPCODE(OP_GET_GLOBAL, "OP_GET_GLOBAL")          /* short global */ \
+    EMIT_OPCODE(OP_DEFINE_GLOBAL, "OP_DEFINE_GLOBAL")    /* short global */ \
+    EMIT_OPCODE(OP_SET_GLOBAL, "OP_SET_GLOBAL")          /* short global */ \
+    EMIT_OPCODE(OP_GET_UPVALUE, "OP_GET_UPVALUE")        /* byte upvalue */ \
+    EMIT_OPCODE(OP_SET_UPVALUE, "OP_SET_UPVALUE")        /* byte upvalue */ \
+    EMIT_OPCODE(OP_GET_PROPERTY, "OP_GET_PROPERTY")      /* short name */ \
+    EMIT_OPCODE(OP_SET_PROPERTY, "OP_SET_PROPERTY")      /* short name */ \
+    EMIT_OPCODE(OP_GET_SUPER, "OP_GET_SUPER")            /* short name */ \
+    EMIT_OPCODE(OP_EQUAL, "OP_EQUAL") \
+    EMIT_OPCODE(OP_NOT_EQUAL, "OP_NOT_EQUAL") \
+    EMIT_OPCODE(OP_GREATER, "OP_GREATER") \
+    EMIT_OPCODE(OP_GREATER_EQUAL, "OP_GREATER_EQUAL") \
+    EMIT_OPCODE(OP_LESS, "OP_LESS") \
+    EMIT_OPCODE(OP_LESS_EQUAL, "OP_LESS_EQUAL") \
+    EMIT_OPCODE(OP_ADD, "OP_ADD") \
+    EMIT_OPCODE(OP_SUBTRACT, "OP_SUBTRACT") \
+    EMIT_OPCODE(OP_MULTIPLY, "OP_MULTIPLY") \
+    EMIT_OPCODE(OP_DIVIDE, "OP_DIVIDE") \
+    EMIT_OPCODE(OP_NOT, "OP_NOT") \
+    EMIT_OPCODE(OP_NEGATE, "OP_NEGATE") \
+    EMIT_OPCODE(OP_PRINT, "OP_PRINT") \
+    EMIT_OPCODE(OP_INPUT, "OP_INPUT") \
+    EMIT_OPCODE(OP_JUMP, "OP_JUMP")                      /* short offset */ \
+    EMIT_OPCODE(OP_JUMP_IF_FALSE, "OP_JUMP_IF_FALSE")    /* short offset */ \
+    EMIT_OPCODE(OP_LOOP, "OP_LOOP")                      /* short offset */ \
+    EMIT_OPCODE(OP_CALL, "OP_CALL")                      /* byte argc */ \
+    EMIT_OPCODE(OP_INVOKE, "OP_INVOKE")                  /* short name, byte argc */ \
+    EMIT_OPCODE(OP_SUPER_INVOKE, "OP_SUPER_INVOKE")      /* short name, byte argc */ \
+    EMIT_OPCODE(OP_CLOSURE, "OP_CLOSURE")                /* short function, (byte local, byte index)* */ \
+    EMIT_OPCODE(OP_CLOSE_UPVALUE, "OP_CLOSE_UPVALUE") \
+    EMIT_OPCODE(OP_RETURN, "OP_RETURN") \
+    EMIT_OPCODE(OP_CLASS, "OP_CLASS")                    /* short name */ \
+    EMIT_OPCODE(OP_INHERIT, "OP_INHERIT") \
+    EMIT_OPCODE(OP_METHOD, "OP_METHOD")                  /* short name */ \
+    EMIT_OPCODE(OP_FIELDS, "OP_FIELDS") \
+    EMIT_OPCODE(OP_DEFINE_FIELD, "OP_DEFINE_FIELD")      /* short name */
+
+#define EMIT_OPCODE(id, str) id,
+enum OpCode : uint8_t {
+    OPCODE_LIST
+#undef EMIT_OPCODE
+    OPCODE_NUM
+};
+
+std::string opcodeToStr(OpCode op);
+
+class Chunk final
+{
+public:
+    Chunk() = default;
+    ~Chunk() = default;
+
+    void write(uint8_t byte, int line);
+
+    // Returns the index of the value in the constant table
+    size_t addConstant(const Value& value);
+
+    // Prints a human readable listing of the chunk
+    void disassemble(const std::string& name) const;
+
+    // Prints the instruction at offset, returns the offset of the next one
+    size_t disassembleInstruction(size_t offset) const;
+
+    std::vector<uint8_t> m_code;
+    std::vector<int> m_lines;
+    std::vector<Value> m_constants;
+};
+
+}
+
+#endif
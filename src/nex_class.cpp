@@ -1,58 +1,75 @@
 #include "nex_class.hpp"
 #include "nex_function.hpp"
 
-#include <map>
+#include <vector>
 
 namespace nex {
-NexClass::NexClass(std::wstring const& name,
-                   std::shared_ptr<NexClass> superclass,
+
+static uint32_t s_nextShape = 1;
+
+static const Symbol s_init = SymbolTable::intern("init");
+
+NexClass::NexClass(std::string const& name,
+                   Ref<NexClass> superclass,
                    Fields  const& fields,
-                   Methods const& methods)
+                   Methods const& methods,
+                   HeapVector<Ref<Cell>> fieldCells)
     : m_name(name)
     , m_superclass(superclass)
-    , m_fields(fields)
+    , m_fields()
     , m_methods(methods)
-{}
+    , m_fieldCells(std::move(fieldCells))
+    , m_shape(s_nextShape++)
+    , m_fieldSlots()
+{
+    // A field declared twice keeps its first offset and its last initializer
+    for (auto let : fields) {
+        auto [it, bInserted] = m_fieldSlots.emplace(let->m_name.m_symbol,
+                                                    static_cast<uint32_t>(m_fields.size()));
+        if (bInserted) {
+            m_fields.push_back(let);
+        }
+        else {
+            m_fields[it->second] = let;
+        }
+    }
+}
 
 size_t NexClass::arity() const
 {
-    auto initializer = findMethod(L"init");
+    auto initializer = findMethod(s_init);
     if (!initializer) {
         return 0;
     }
     return initializer->arity();
 }
 
-std::any NexClass::call(Interpreter* interp, std::vector<std::any> arguments)
+Value NexClass::call(Interpreter* interp, Arguments arguments)
 {
-    std::map<std::wstring, std::any> instanceFields;
-    for (auto& [name, let] : m_fields) {
-        interp->visitLetStmt(let.get());
-        instanceFields[name] = interp->getEnv()->get(let->m_name);
-    }
-
-    auto instance = std::make_shared<NexInstance>(this, instanceFields);
+    auto instance = Heap::make<NexInstance>(this, HeapVector<Value>(m_fields.size()));
+    interp->initializeFields(this, instance.get());
 
-    auto initializer = findMethod(L"init");
+    auto initializer = findMethod(s_init);
     if (initializer) {
-        initializer->bind(instance)->call(interp, arguments);
+        initializer->callMethod(interp, instance.get(), arguments);
     }
 
-    return std::make_any<std::shared_ptr<NexInstance>>(instance);
+    return instance;
 }
 
-std::wstring NexClass::to_string() const {
-    return L"<class '" + m_name + L"'>";
+std::string NexClass::to_string() const {
+    return "<class '" + m_name + "'>";
 }
 
-std::wstring NexClass::name() const {
+std::string NexClass::name() const {
     return m_name;
 }
 
-std::shared_ptr<NexFunction> NexClass::findMethod(std::wstring const& name) const
+NexFunction* NexClass::findMethod(Symbol name) const
 {
-    if (m_methods.count(name)) {
-        return m_methods.at(name);
+    auto it = m_methods.find(name);
+    if (it != m_methods.end()) {
+        return it->second.get();
     }
 
     if (m_superclass) {
@@ -62,4 +79,38 @@ std::shared_ptr<NexFunction> NexClass::findMethod(std::wstring const& name) cons
     return nullptr;
 }
 
-}
\ No newline at end of file
+PropertySlot NexClass::findProperty(Symbol name) const
+{
+    // Fields shadow methods
+    auto it = m_fieldSlots.find(name);
+    if (it != m_fieldSlots.end()) {
+        return { m_shape, PropertySlot::FIELD, it->second, nullptr };
+    }
+
+    if (auto pMethod = findMethod(name)) {
+        return { m_shape, PropertySlot::METHOD, 0, pMethod };
+    }
+
+    return { m_shape, PropertySlot::NONE, 0, nullptr };
+}
+
+void NexClass::trace(Tracer& tracer)
+{
+    tracer.visit(m_superclass);
+    for (const auto& cell : m_fieldCells) {
+        tracer.visit(cell);
+    }
+    for (auto& [name, method] : m_methods) {
+        (void) name;
+        tracer.visit(method);
+    }
+}
+
+void NexClass::clear()
+{
+    m_superclass = nullptr;
+    m_methods.clear();
+    m_fieldCells.clear();
+}
+
+}
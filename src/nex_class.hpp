@@ -2,12 +2,16 @@
 #define NEX_NEX_CLASS_HPP
 
 #include "nex_callable.hpp"
+#include "nex_inline_cache.hpp"
 #include "nex_instance.hpp"
 #include "nex_function.hpp"
 #include "nex_stmt.hpp"
+#include "nex_symbol.hpp"
 
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace nex {
 
@@ -18,33 +22,59 @@ class Interpreter;
 class NexClass : public NexCallable
 {
 public:
-    using Fields = std::map<std::wstring, std::shared_ptr<stmt::Let>>;
-    using Methods = std::map<std::wstring, std::shared_ptr<NexFunction>>;
+    // Declarations of the fields, in source order
+    using Fields = std::vector<stmt::Let*>;
+    using Methods = std::unordered_map<Symbol, Ref<NexFunction>>;
 
 public:
-    NexClass() = default;
-    NexClass(std::wstring const& name,
-             std::shared_ptr<NexClass> m_superclass,
+    // 'fieldCells' are the cells the field initializers captured
+    NexClass(std::string const& name,
+             Ref<NexClass> m_superclass,
              Fields const& fields,
-             Methods const& methods);
+             Methods const& methods,
+             HeapVector<Ref<Cell>> fieldCells);
 
     virtual ~NexClass() = default;
 
     size_t arity() const override;
 
-    std::any call(Interpreter* interp, std::vector<std::any> arguments) override;
+    Value call(Interpreter* interp, Arguments arguments) override;
 
-    std::wstring to_string() const override;
+    std::string to_string() const override;
 
-    std::wstring name() const override;
+    std::string name() const override;
 
-    std::shared_ptr<NexFunction> findMethod(std::wstring const& name) const;
+    NexFunction* findMethod(Symbol name) const;
 
-    std::wstring m_name;
-    std::shared_ptr<NexClass> m_superclass;
+    // Where 'name' lives on instances of this class, kind is NONE if they
+    // have no such property
+    PropertySlot findProperty(Symbol name) const;
+
+    void trace(Tracer& tracer) override;
+    void clear() override;
+
+    std::string m_name;
+    Ref<NexClass> m_superclass;
+    // The field at offset N is initialized by m_fields[N]
     Fields m_fields;
     Methods m_methods;
+    HeapVector<Ref<Cell>> m_fieldCells;
+    // The class is the hidden class of its instances: they all have the
+    // declared fields at the offsets in m_fieldSlots, and m_shape identifies
+    // that layout in inline caches.
+    const uint32_t m_shape;
+    std::unordered_map<Symbol, uint32_t> m_fieldSlots;
 };
+
+inline Value::Value(NexClass* pKlass)
+    : Value(ValueType::CLASS, pKlass)
+{}
+
+inline NexClass* Value::asClass() const
+{
+    return static_cast<NexClass*>(m_as.pObject);
+}
+
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,799 @@
+#include "nex_compiler.hpp"
+#include "nex_diag.hpp"
+#include "nex_vm.hpp"
+
+#include <limits>
+
+namespace nex {
+
+namespace {
+
+const Symbol s_this = SymbolTable::intern("this");
+const Symbol s_super = SymbolTable::intern("super");
+
+// Slots an instruction pushes (positive) or pops. Calls pop their arguments
+// on top of this, the compiler accounts for them where it emits the call.
+int stackEffect(OpCode op)
+{
+    switch (op) {
+    case OP_CONSTANT:
+    case OP_NIL:
+    case OP_TRUE:
+    case OP_FALSE:
+    case OP_GET_LOCAL:
+    case OP_GET_GLOBAL:
+    case OP_GET_UPVALUE:
+    case OP_INPUT:
+    case OP_CLOSURE:
+    case OP_CLASS:
+        return 1;
+    case OP_SET_LOCAL:
+    case OP_SET_GLOBAL:
+    case OP_SET_UPVALUE:
+    case OP_GET_PROPERTY:
+    case OP_NOT:
+    case OP_NEGATE:
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+    case OP_LOOP:
+    case OP_CALL:
+    case OP_INVOKE:
+        return 0;
+    case OP_POP:
+    case OP_DEFINE_GLOBAL:
+    case OP_SET_PROPERTY:
+    case OP_GET_SUPER:
+    case OP_EQUAL:
+    case OP_NOT_EQUAL:
+    case OP_GREATER:
+    case OP_GREATER_EQUAL:
+    case OP_LESS:
+    case OP_LESS_EQUAL:
+    case OP_ADD:
+    case OP_SUBTRACT:
+    case OP_MULTIPLY:
+    case OP_DIVIDE:
+    case OP_PRINT:
+    case OP_SUPER_INVOKE:
+    case OP_CLOSE_UPVALUE:
+    case OP_RETURN:
+    case OP_INHERIT:
+    case OP_METHOD:
+    case OP_FIELDS:
+        return -1;
+    case OP_DEFINE_FIELD:
+        return -2;
+    case OPCODE_NUM:
+        break;
+    }
+    return 0;
+}
+
+}
+
+Compiler::Compiler(VM& vm)
+    : m_vm(vm)
+    , m_pCurrent(nullptr)
+    , m_line(0)
+    , m_bHadError(false)
+{}
+
+Ref<vm::Function> Compiler::compile(ArenaList<stmt::Stmt*> stmts)
+{
+    FunctionState script;
+    beginFunction(script, "<script>", TYPE_SCRIPT);
+
+    for (auto s : stmts) {
+        compile(s);
+    }
+
+    auto function = endFunction();
+    if (m_bHadError) {
+        return nullptr;
+    }
+    return function;
+}
+
+void Compiler::compile(stmt::Stmt* stmt)
+{
+    stmt->accept(this);
+}
+
+void Compiler::compile(expr::Expr* expr)
+{
+    expr->accept(this);
+}
+
+void Compiler::visitBlockStmt(stmt::Block* stmt)
+{
+    beginScope();
+    for (auto s : stmt->m_statements) {
+        compile(s);
+    }
+    endScope();
+}
+
+void Compiler::visitClassStmt(stmt::Class* stmt)
+{
+    m_line = stmt->m_name.m_line;
+    auto name = stmt->m_name.m_symbol;
+    auto nameConstant = identifierConstant(name);
+    declareVariable(stmt->m_name);
+
+    emitOp(OP_CLASS);
+    emitShort(nameConstant);
+    defineVariable(stmt->m_name);
+
+    if (stmt->m_superclass) {
+        compile(stmt->m_superclass);
+
+        // The superclass stays on the stack as the 'super' local that
+        // methods capture
+        beginScope();
+        addLocal(s_super);
+        markInitialized();
+
+        namedVariable(name, nullptr);
+        emitOp(OP_INHERIT);
+    }
+
+    namedVariable(name, nullptr);
+
+    if (!stmt->m_fields.empty()) {
+        fieldInitializer(stmt);
+    }
+
+    for (auto method : stmt->m_methods) {
+        auto type = method->m_name.lexeme() == "init" ? TYPE_INITIALIZER : TYPE_METHOD;
+        function(method, type);
+        emitOp(OP_METHOD);
+        emitShort(identifierConstant(method->m_name.m_symbol));
+    }
+
+    emitOp(OP_POP);
+
+    if (stmt->m_superclass) {
+        endScope();
+    }
+}
+
+void Compiler::visitExpressionStmt(stmt::Expression* stmt)
+{
+    compile(stmt->m_e);
+    emitOp(OP_POP);
+}
+
+void Compiler::visitFunctionStmt(stmt::Function* stmt)
+{
+    m_line = stmt->m_name.m_line;
+    declareVariable(stmt->m_name);
+    markInitialized();
+    function(stmt, TYPE_FUNCTION);
+    defineVariable(stmt->m_name);
+}
+
+void Compiler::visitIfStmt(stmt::If* stmt)
+{
+    compile(stmt->m_cond);
+    auto depth = m_pCurrent->stackDepth;
+
+    auto thenJump = emitJump(OP_JUMP_IF_FALSE);
+    emitOp(OP_POP);
+    compile(stmt->m_thenBranch);
+
+    // The else branch starts with the condition still on the stack
+    auto elseJump = emitJump(OP_JUMP);
+    patchJump(thenJump);
+    m_pCurrent->stackDepth = depth;
+    emitOp(OP_POP);
+
+    if (stmt->m_elseBranch) {
+        compile(stmt->m_elseBranch);
+    }
+    patchJump(elseJump);
+}
+
+void Compiler::visitPrintStmt(stmt::Print* stmt)
+{
+    compile(stmt->m_e);
+    emitOp(OP_PRINT);
+}
+
+void Compiler::visitReturnStmt(stmt::Return* stmt)
+{
+    m_line = stmt->m_keyword.m_line;
+    if (m_pCurrent->type == TYPE_INITIALIZER) {
+        // The resolver rejects 'ret <value>' in initializers
+        emitOp(OP_GET_LOCAL);
+        emitByte(0);
+    }
+    else if (stmt->m_value) {
+        compile(stmt->m_value);
+    }
+    else {
+        emitOp(OP_NIL);
+    }
+    emitOp(OP_RETURN);
+}
+
+void Compiler::visitLetStmt(stmt::Let* stmt)
+{
+    m_line = stmt->m_name.m_line;
+    declareVariable(stmt->m_name);
+
+    if (stmt->m_init) {
+        compile(stmt->m_init);
+    }
+    else {
+        emitOp(OP_NIL);
+    }
+
+    defineVariable(stmt->m_name);
+}
+
+void Compiler::visitWhileStmt(stmt::While* stmt)
+{
+    auto loopStart = currentChunk().m_code.size();
+    compile(stmt->m_cond);
+    auto depth = m_pCurrent->stackDepth;
+
+    auto exitJump = emitJump(OP_JUMP_IF_FALSE);
+    emitOp(OP_POP);
+    compile(stmt->m_body);
+    emitLoop(loopStart);
+
+    // The loop exits with the condition still on the stack
+    patchJump(exitJump);
+    m_pCurrent->stackDepth = depth;
+    emitOp(OP_POP);
+}
+
+Value Compiler::visitAssignExpr(expr::Assign* expr)
+{
+    m_line = expr->m_name.m_line;
+    namedVariable(expr->m_name.m_symbol, expr->m_value);
+    return nullptr;
+}
+
+Value Compiler::visitBinaryExpr(expr::Binary* expr)
+{
+    compile(expr->m_left);
+    compile(expr->m_right);
+
+    m_line = expr->m_op.m_line;
+    switch (expr->m_op.m_type) {
+    case GREATER: emitOp(OP_GREATER); break;
+    case GREATER_EQUAL: emitOp(OP_GREATER_EQUAL); break;
+    case LESS: emitOp(OP_LESS); break;
+    case LESS_EQUAL: emitOp(OP_LESS_EQUAL); break;
+    case MINUS: emitOp(OP_SUBTRACT); break;
+    case SLASH: emitOp(OP_DIVIDE); break;
+    case STAR: emitOp(OP_MULTIPLY); break;
+    case PLUS: emitOp(OP_ADD); break;
+    case BANG_EQUAL: emitOp(OP_NOT_EQUAL); break;
+    case EQUAL_EQUAL: emitOp(OP_EQUAL); break;
+    default:
+        // The interpreter evaluates unknown operators to nil
+        emitOp(OP_POP);
+        emitOp(OP_POP);
+        emitOp(OP_NIL);
+        break;
+    }
+    return nullptr;
+}
+
+Value Compiler::visitCallExpr(expr::Call* expr)
+{
+    auto argc = static_cast<uint8_t>(expr->m_arguments.size());
+
+    // Method calls skip the bound method allocation
+    if (auto pGet = dynamic_cast<expr::Get*>(expr->m_callee)) {
+        compile(pGet->m_object);
+        for (auto arg : expr->m_arguments) {
+            compile(arg);
+        }
+        m_line = expr->m_paren.m_line;
+        emitOp(OP_INVOKE);
+        emitShort(identifierConstant(pGet->m_name.m_symbol));
+        emitByte(argc);
+        adjustStack(-argc);
+        return nullptr;
+    }
+
+    if (auto pSuper = dynamic_cast<expr::Super*>(expr->m_callee)) {
+        namedVariable(s_this, nullptr);
+        for (auto arg : expr->m_arguments) {
+            compile(arg);
+        }
+        namedVariable(s_super, nullptr);
+        m_line = expr->m_paren.m_line;
+        emitOp(OP_SUPER_INVOKE);
+        emitShort(identifierConstant(pSuper->m_method.m_symbol));
+        emitByte(argc);
+        adjustStack(-argc);
+        return nullptr;
+    }
+
+    compile(expr->m_callee);
+    for (auto arg : expr->m_arguments) {
+        compile(arg);
+    }
+    m_line = expr->m_paren.m_line;
+    emitOp(OP_CALL);
+    emitByte(argc);
+    adjustStack(-argc);
+    return nullptr;
+}
+
+Value Compiler::visitGetExpr(expr::Get* expr)
+{
+    compile(expr->m_object);
+    m_line = expr->m_name.m_line;
+    emitOp(OP_GET_PROPERTY);
+    emitShort(identifierConstant(expr->m_name.m_symbol));
+    return nullptr;
+}
+
+Value Compiler::visitSetExpr(expr::Set* expr)
+{
+    compile(expr->m_object);
+    compile(expr->m_value);
+    m_line = expr->m_name.m_line;
+    emitOp(OP_SET_PROPERTY);
+    emitShort(identifierConstant(expr->m_name.m_symbol));
+    return nullptr;
+}
+
+Value Compiler::visitSuperExpr(expr::Super* expr)
+{
+    m_line = expr->m_keyword.m_line;
+    namedVariable(s_this, nullptr);
+    namedVariable(s_super, nullptr);
+    emitOp(OP_GET_SUPER);
+    emitShort(identifierConstant(expr->m_method.m_symbol));
+    return nullptr;
+}
+
+Value Compiler::visitThisExpr(expr::This* expr)
+{
+    m_line = expr->m_keyword.m_line;
+    namedVariable(s_this, nullptr);
+    return nullptr;
+}
+
+Value Compiler::visitGroupingExpr(expr::Grouping* expr)
+{
+    compile(expr->m_expression);
+    return nullptr;
+}
+
+Value Compiler::visitLiteralExpr(expr::Literal* expr)
+{
+    auto& value = expr->m_value;
+    if (value.isNil()) {
+        emitOp(OP_NIL);
+    }
+    else if (value.isBool()) {
+        emitOp(value.asBool() ? OP_TRUE : OP_FALSE);
+    }
+    else {
+        emitOp(OP_CONSTANT);
+        emitShort(makeConstant(value));
+    }
+    return nullptr;
+}
+
+Value Compiler::visitLogicalExpr(expr::Logical* expr)
+{
+    compile(expr->m_left);
+
+    if (expr->m_op.m_type == OR) {
+        auto elseJump = emitJump(OP_JUMP_IF_FALSE);
+        auto endJump = emitJump(OP_JUMP);
+        patchJump(elseJump);
+        emitOp(OP_POP);
+        compile(expr->m_right);
+        patchJump(endJump);
+    }
+    else {
+        auto endJump = emitJump(OP_JUMP_IF_FALSE);
+        emitOp(OP_POP);
+        compile(expr->m_right);
+        patchJump(endJump);
+    }
+    return nullptr;
+}
+
+Value Compiler::visitUnaryExpr(expr::Unary* expr)
+{
+    compile(expr->m_right);
+
+    m_line = expr->m_op.m_line;
+    switch (expr->m_op.m_type) {
+    case BANG: emitOp(OP_NOT); break;
+    case MINUS: emitOp(OP_NEGATE); break;
+    default:
+        emitOp(OP_POP);
+        emitOp(OP_NIL);
+        break;
+    }
+    return nullptr;
+}
+
+Value Compiler::visitCommaExpr(expr::Comma* expr)
+{
+    for (auto e : expr->m_exprs) {
+        compile(e);
+        emitOp(OP_POP);
+    }
+    compile(expr->m_last);
+    return nullptr;
+}
+
+Value Compiler::visitVariableExpr(expr::Variable* expr)
+{
+    m_line = expr->m_name.m_line;
+    namedVariable(expr->m_name.m_symbol, nullptr);
+    return nullptr;
+}
+
+Value Compiler::visitInputExpr(expr::Input* expr)
+{
+    (void) expr;
+    emitOp(OP_INPUT);
+    return nullptr;
+}
+
+void Compiler::beginFunction(FunctionState& state, const std::string& name, FunctionType type)
+{
+    state.pEnclosing = m_pCurrent;
+    state.function = make_ref<vm::Function>(name);
+    state.type = type;
+    state.scopeDepth = 0;
+    state.stackDepth = 1;
+    state.maxStackDepth = 1;
+
+    // Slot zero holds the callee, or the receiver inside methods
+    auto bIsMethod = type == TYPE_METHOD || type == TYPE_INITIALIZER;
+    state.locals.push_back({ bIsMethod ? s_this : nullptr, 0, false });
+
+    m_pCurrent = &state;
+}
+
+Ref<vm::Function> Compiler::endFunction()
+{
+    emitReturn();
+
+    auto function = m_pCurrent->function;
+    function->m_upvalueCount = m_pCurrent->upvalues.size();
+    function->m_maxSlots = m_pCurrent->maxStackDepth;
+    m_pCurrent = m_pCurrent->pEnclosing;
+
+#if defined(DBG_BYTECODE)
+    if (!m_bHadError) {
+        function->m_chunk.disassemble(function->m_name);
+    }
+#endif
+
+    return function;
+}
+
+void Compiler::function(stmt::Function* stmt, FunctionType type)
+{
+    FunctionState state;
+    beginFunction(state, stmt->m_name.lexeme(), type);
+    beginScope();
+
+    for (auto& param : stmt->m_params) {
+        m_pCurrent->function->m_arity++;
+        adjustStack(1);
+        addLocal(param.m_symbol);
+        markInitialized();
+    }
+
+    for (auto s : stmt->m_body) {
+        compile(s);
+    }
+
+    auto function = endFunction();
+
+    emitOp(OP_CLOSURE);
+    emitShort(makeConstant(Value(ValueType::VM_FUNCTION, function.get())));
+    for (auto& upvalue : state.upvalues) {
+        emitByte(upvalue.bIsLocal ? 1 : 0);
+        emitByte(upvalue.index);
+    }
+}
+
+void Compiler::fieldInitializer(stmt::Class* stmt)
+{
+    // Instance fields are declared by a method the VM runs on every new
+    // instance before 'init'
+    FunctionState state;
+    beginFunction(state, stmt->m_name.lexeme(), TYPE_METHOD);
+
+    for (auto field : stmt->m_fields) {
+        m_line = field->m_name.m_line;
+        emitOp(OP_GET_LOCAL);
+        emitByte(0);
+
+        if (field->m_init) {
+            compile(field->m_init);
+        }
+        else {
+            emitOp(OP_NIL);
+        }
+
+        emitOp(OP_DEFINE_FIELD);
+        emitShort(identifierConstant(field->m_name.m_symbol));
+    }
+
+    auto function = endFunction();
+
+    emitOp(OP_CLOSURE);
+    emitShort(makeConstant(Value(ValueType::VM_FUNCTION, function.get())));
+    for (auto& upvalue : state.upvalues) {
+        emitByte(upvalue.bIsLocal ? 1 : 0);
+        emitByte(upvalue.index);
+    }
+    emitOp(OP_FIELDS);
+}
+
+void Compiler::beginScope()
+{
+    m_pCurrent->scopeDepth++;
+}
+
+void Compiler::endScope()
+{
+    auto& locals = m_pCurrent->locals;
+    m_pCurrent->scopeDepth--;
+
+    while (!locals.empty() && locals.back().depth > m_pCurrent->scopeDepth) {
+        emitOp(locals.back().bIsCaptured ? OP_CLOSE_UPVALUE : OP_POP);
+        locals.pop_back();
+    }
+}
+
+void Compiler::addLocal(Symbol name)
+{
+    if (m_pCurrent->locals.size() > std::numeric_limits<uint8_t>::max()) {
+        error("Too many local variables in function.");
+        return;
+    }
+
+    m_pCurrent->locals.push_back({ name, -1, false });
+}
+
+void Compiler::declareVariable(SlimToken const& name)
+{
+    if (m_pCurrent->scopeDepth == 0) {
+        return;
+    }
+
+    addLocal(name.m_symbol);
+}
+
+void Compiler::defineVariable(SlimToken const& name)
+{
+    if (m_pCurrent->scopeDepth > 0) {
+        markInitialized();
+        return;
+    }
+
+    emitOp(OP_DEFINE_GLOBAL);
+    emitShort(globalSlot(name.m_symbol));
+}
+
+void Compiler::markInitialized()
+{
+    if (m_pCurrent->scopeDepth == 0) {
+        return;
+    }
+
+    m_pCurrent->locals.back().depth = m_pCurrent->scopeDepth;
+}
+
+int Compiler::resolveLocal(FunctionState* pState, Symbol name)
+{
+    for (int idx = pState->locals.size() - 1; idx >= 0; idx--) {
+        if (pState->locals[idx].name == name) {
+            return idx;
+        }
+    }
+
+    return -1;
+}
+
+int Compiler::resolveUpvalue(FunctionState* pState, Symbol name)
+{
+    if (!pState->pEnclosing) {
+        return -1;
+    }
+
+    auto local = resolveLocal(pState->pEnclosing, name);
+    if (local != -1) {
+        pState->pEnclosing->locals[local].bIsCaptured = true;
+        return addUpvalue(pState, static_cast<uint8_t>(local), true);
+    }
+
+    auto upvalue = resolveUpvalue(pState->pEnclosing, name);
+    if (upvalue != -1) {
+        return addUpvalue(pState, static_cast<uint8_t>(upvalue), false);
+    }
+
+    return -1;
+}
+
+int Compiler::addUpvalue(FunctionState* pState, uint8_t index, bool bIsLocal)
+{
+    auto& upvalues = pState->upvalues;
+    for (size_t idx = 0; idx < upvalues.size(); idx++) {
+        if (upvalues[idx].index == index && upvalues[idx].bIsLocal == bIsLocal) {
+            return idx;
+        }
+    }
+
+    if (upvalues.size() > std::numeric_limits<uint8_t>::max()) {
+        error("Too many closure variables in function.");
+        return 0;
+    }
+
+    upvalues.push_back({ index, bIsLocal });
+    return upvalues.size() - 1;
+}
+
+void Compiler::namedVariable(Symbol name, expr::Expr* assignValue)
+{
+    OpCode getOp, setOp;
+    int arg = resolveLocal(m_pCurrent, name);
+    bool bIsGlobal = false;
+
+    if (arg != -1) {
+        getOp = OP_GET_LOCAL;
+        setOp = OP_SET_LOCAL;
+    }
+    else if ((arg = resolveUpvalue(m_pCurrent, name)) != -1) {
+        getOp = OP_GET_UPVALUE;
+        setOp = OP_SET_UPVALUE;
+    }
+    else {
+        arg = globalSlot(name);
+        getOp = OP_GET_GLOBAL;
+        setOp = OP_SET_GLOBAL;
+        bIsGlobal = true;
+    }
+
+    if (assignValue) {
+        compile(assignValue);
+    }
+
+    emitOp(assignValue ? setOp : getOp);
+    if (bIsGlobal) {
+        emitShort(static_cast<uint16_t>(arg));
+    }
+    else {
+        emitByte(static_cast<uint8_t>(arg));
+    }
+}
+
+Chunk& Compiler::currentChunk()
+{
+    return m_pCurrent->function->m_chunk;
+}
+
+void Compiler::emitByte(uint8_t byte)
+{
+    currentChunk().write(byte, m_line);
+}
+
+void Compiler::emitOp(OpCode op)
+{
+    emitByte(op);
+    adjustStack(stackEffect(op));
+}
+
+void Compiler::adjustStack(int effect)
+{
+    auto& state = *m_pCurrent;
+    state.stackDepth += effect;
+    if (state.stackDepth > state.maxStackDepth) {
+        state.maxStackDepth = state.stackDepth;
+    }
+}
+
+void Compiler::emitShort(uint16_t value)
+{
+    emitByte((value >> 8) & 0xff);
+    emitByte(value & 0xff);
+}
+
+void Compiler::emitReturn()
+{
+    if (m_pCurrent->type == TYPE_INITIALIZER) {
+        emitOp(OP_GET_LOCAL);
+        emitByte(0);
+    }
+    else {
+        emitOp(OP_NIL);
+    }
+    emitOp(OP_RETURN);
+}
+
+uint16_t Compiler::globalSlot(Symbol name)
+{
+    auto slot = m_vm.globalSlot(name);
+    if (slot > std::numeric_limits<uint16_t>::max()) {
+        error("Too many global variables.");
+        return 0;
+    }
+
+    return static_cast<uint16_t>(slot);
+}
+
+uint16_t Compiler::makeConstant(const Value& value)
+{
+    auto constant = currentChunk().addConstant(value);
+    if (constant > std::numeric_limits<uint16_t>::max()) {
+        error("Too many constants in one chunk.");
+        return 0;
+    }
+
+    return static_cast<uint16_t>(constant);
+}
+
+uint16_t Compiler::identifierConstant(Symbol name)
+{
+    auto& identifiers = m_pCurrent->identifiers;
+    auto it = identifiers.find(name);
+    if (it != identifiers.end()) {
+        return it->second;
+    }
+
+    // The VM keys fields and methods by symbol
+    auto constant = makeConstant(name);
+    identifiers[name] = constant;
+    return constant;
+}
+
+size_t Compiler::emitJump(OpCode op)
+{
+    emitOp(op);
+    emitByte(0xff);
+    emitByte(0xff);
+    return currentChunk().m_code.size() - 2;
+}
+
+void Compiler::patchJump(size_t offset)
+{
+    auto& code = currentChunk().m_code;
+    auto jump = code.size() - offset - 2;
+
+    if (jump > std::numeric_limits<uint16_t>::max()) {
+        error("Too much code to jump over.");
+        return;
+    }
+
+    code[offset] = (jump >> 8) & 0xff;
+    code[offset + 1] = jump & 0xff;
+}
+
+void Compiler::emitLoop(size_t loopStart)
+{
+    emitOp(OP_LOOP);
+
+    auto offset = currentChunk().m_code.size() - loopStart + 2;
+    if (offset > std::numeric_limits<uint16_t>::max()) {
+        error("Loop body too large.");
+    }
+
+    emitShort(static_cast<uint16_t>(offset));
+}
+
+void Compiler::error(const std::string& msg)
+{
+    ::nex::error(m_line, msg);
+    m_bHadError = true;
+}
+
+}
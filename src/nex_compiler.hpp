@@ -0,0 +1,142 @@
+#ifndef NEX_COMPILER_HPP
+#define NEX_COMPILER_HPP
+
+#include "nex_chunk.hpp"
+#include "nex_expr.hpp"
+#include "nex_stmt.hpp"
+#include "nex_token.hpp"
+#include "nex_vm_object.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nex {
+
+using namespace nex::ast;
+
+class VM;
+
+// Lowers a resolved program into bytecode for the VM. The Resolver must
+// have accepted the program first, the compiler relies on it for scoping
+// errors and only reports bytecode limits itself.
+class Compiler final : public expr::Visitor, public stmt::Visitor
+{
+public:
+    explicit Compiler(VM& vm);
+    ~Compiler() = default;
+
+    // Returns the top level script function, or nullptr on error
+    Ref<vm::Function> compile(ArenaList<stmt::Stmt*> stmts);
+
+    inline bool error() const { return m_bHadError; }
+
+    void visitBlockStmt(stmt::Block* stmt) override;
+    void visitClassStmt(stmt::Class* stmt) override;
+    void visitExpressionStmt(stmt::Expression* stmt) override;
+    void visitFunctionStmt(stmt::Function* stmt) override;
+    void visitIfStmt(stmt::If* stmt) override;
+    void visitPrintStmt(stmt::Print* stmt) override;
+    void visitReturnStmt(stmt::Return* stmt) override;
+    void visitLetStmt(stmt::Let* stmt) override;
+    void visitWhileStmt(stmt::While* stmt) override;
+
+    Value visitAssignExpr(expr::Assign* expr) override;
+    Value visitBinaryExpr(expr::Binary* expr) override;
+    Value visitCallExpr(expr::Call* expr) override;
+    Value visitGetExpr(expr::Get* expr) override;
+    Value visitSetExpr(expr::Set* expr) override;
+    Value visitSuperExpr(expr::Super* expr) override;
+    Value visitThisExpr(expr::This* expr) override;
+    Value visitGroupingExpr(expr::Grouping* expr) override;
+    Value visitLiteralExpr(expr::Literal* expr) override;
+    Value visitLogicalExpr(expr::Logical* expr) override;
+    Value visitUnaryExpr(expr::Unary* expr) override;
+    Value visitCommaExpr(expr::Comma* expr) override;
+    Value visitVariableExpr(expr::Variable* expr) override;
+    Value visitInputExpr(expr::Input* expr) override;
+
+private:
+    enum FunctionType {
+        TYPE_SCRIPT,
+        TYPE_FUNCTION,
+        TYPE_METHOD,
+        TYPE_INITIALIZER,
+    };
+
+    struct Local {
+        // Null for the unnamed callee slot
+        Symbol name;
+        // -1 while the initializer is being compiled
+        int depth;
+        bool bIsCaptured;
+    };
+
+    struct Upvalue {
+        uint8_t index;
+        bool bIsLocal;
+    };
+
+    struct FunctionState {
+        FunctionState* pEnclosing;
+        Ref<vm::Function> function;
+        FunctionType type;
+        std::vector<Local> locals;
+        std::vector<Upvalue> upvalues;
+        // Constant table index of every property and method name
+        std::unordered_map<Symbol, uint16_t> identifiers;
+        int scopeDepth;
+        // Stack slots in use where the code is emitted and at most so far,
+        // from the callee's slot on
+        size_t stackDepth;
+        size_t maxStackDepth;
+    };
+
+    void compile(stmt::Stmt* stmt);
+    void compile(expr::Expr* expr);
+
+    void beginFunction(FunctionState& state, const std::string& name, FunctionType type);
+    Ref<vm::Function> endFunction();
+    void function(stmt::Function* stmt, FunctionType type);
+    void fieldInitializer(stmt::Class* stmt);
+
+    void beginScope();
+    void endScope();
+
+    void addLocal(Symbol name);
+    void declareVariable(SlimToken const& name);
+    void defineVariable(SlimToken const& name);
+    void markInitialized();
+
+    int resolveLocal(FunctionState* pState, Symbol name);
+    int resolveUpvalue(FunctionState* pState, Symbol name);
+    uint16_t globalSlot(Symbol name);
+    int addUpvalue(FunctionState* pState, uint8_t index, bool bIsLocal);
+    void namedVariable(Symbol name, expr::Expr* assignValue);
+
+    Chunk& currentChunk();
+    void emitByte(uint8_t byte);
+    void emitOp(OpCode op);
+    // Accounts for slots pushed (positive) or popped by the code emitted
+    void adjustStack(int effect);
+    void emitShort(uint16_t value);
+    void emitReturn();
+    uint16_t makeConstant(const Value& value);
+    uint16_t identifierConstant(Symbol name);
+    size_t emitJump(OpCode op);
+    void patchJump(size_t offset);
+    void emitLoop(size_t loopStart);
+
+    void error(const std::string& msg);
+
+private:
+    VM& m_vm;
+    FunctionState* m_pCurrent;
+    int m_line;
+    bool m_bHadError;
+};
+
+}
+
+#endif
@@ -8,18 +8,23 @@
 
 
 namespace nex {
-    inline void report(int line, std::wstring where, std::wstring msg) {
-        std::wcout << "[line " << line << "] Error " << where << ": " << msg
+    inline void report(int line, std::string where, std::string msg) {
+        std::cout << "[line " << line << "] Error " << where << ": " << msg
                   << std::endl;
     }
 
-    inline void error(int line, std::wstring msg) {
-        report(line, L"", msg);
+    inline void error(int line, std::string msg) {
+        report(line, "", msg);
+    }
+
+    inline void runtimeError(int line, std::string msg)
+    {
+        std::cout << " [line " << line << "] " << msg << std::endl;
     }
 
     inline void runtimeError(const NexRunTimeError& error)
     {
-        std::wcout << error.what()
+        std::cout << error.what()
                    << " [line "
                    << error.m_op.m_line << "] "
                    << error.msg()
@@ -1,9 +1,11 @@
 #ifndef NEX_EXPR_HPP_
 #define NEX_EXPR_HPP_
 
+#include "nex_arena.hpp"
 #include "nex_token.hpp"
-#include <memory>
-#include <vector>
+#include "nex_value.hpp"
+#include "nex_inline_cache.hpp"
+#include "nex_resolution.hpp"
 
 namespace nex::ast::expr {
 struct Assign;
@@ -23,284 +25,274 @@ struct Input;
 
 class Visitor {
 public:
-    virtual std::any visitAssignExpr(Assign* expr) = 0;
-    virtual std::any visitBinaryExpr(Binary* expr) = 0;
-    virtual std::any visitCallExpr(Call* expr) = 0;
-    virtual std::any visitGetExpr(Get* expr) = 0;
-    virtual std::any visitSetExpr(Set* expr) = 0;
-    virtual std::any visitSuperExpr(Super* expr) = 0;
-    virtual std::any visitThisExpr(This* expr) = 0;
-    virtual std::any visitGroupingExpr(Grouping* expr) = 0;
-    virtual std::any visitLiteralExpr(Literal* expr) = 0;
-    virtual std::any visitLogicalExpr(Logical* expr) = 0;
-    virtual std::any visitUnaryExpr(Unary* expr) = 0;
-    virtual std::any visitCommaExpr(Comma* expr) = 0;
-    virtual std::any visitVariableExpr(Variable* expr) = 0;
-    virtual std::any visitInputExpr(Input* expr) = 0;
+    virtual Value visitAssignExpr(Assign* expr) = 0;
+    virtual Value visitBinaryExpr(Binary* expr) = 0;
+    virtual Value visitCallExpr(Call* expr) = 0;
+    virtual Value visitGetExpr(Get* expr) = 0;
+    virtual Value visitSetExpr(Set* expr) = 0;
+    virtual Value visitSuperExpr(Super* expr) = 0;
+    virtual Value visitThisExpr(This* expr) = 0;
+    virtual Value visitGroupingExpr(Grouping* expr) = 0;
+    virtual Value visitLiteralExpr(Literal* expr) = 0;
+    virtual Value visitLogicalExpr(Logical* expr) = 0;
+    virtual Value visitUnaryExpr(Unary* expr) = 0;
+    virtual Value visitCommaExpr(Comma* expr) = 0;
+    virtual Value visitVariableExpr(Variable* expr) = 0;
+    virtual Value visitInputExpr(Input* expr) = 0;
 };
 
 struct Expr {
-    virtual std::any accept(Visitor* visitor) = 0;
+    virtual Value accept(Visitor* visitor) = 0;
 };
 
 struct Assign : public Expr {
-    Assign(Token name, std::shared_ptr<Expr> value) :
+    Assign(SlimToken name, Expr* value) :
         m_name(name),
-        m_value(value)
+        m_value(value),
+        m_resolution()
     {}
 
-    virtual ~Assign() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitAssignExpr(this);
     }
 
-    const Token m_name;
-    const std::shared_ptr<Expr> m_value;
+    SlimToken const m_name;
+    Expr* m_value;
+    Resolution m_resolution;
 };
 
-inline std::shared_ptr<Expr> make_assign(Token name, std::shared_ptr<Expr> value) {
-    return std::make_shared<Assign>(name, value);
+inline Assign* make_assign(Arena& arena, SlimToken name, Expr* value) {
+    return arena.make<Assign>(name, value);
 }
 
 struct Binary : public Expr {
-    Binary(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right) :
+    Binary(Expr* left, SlimToken op, Expr* right) :
         m_left(left),
         m_op(op),
         m_right(right)
     {}
 
-    virtual ~Binary() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitBinaryExpr(this);
     }
 
-    const std::shared_ptr<Expr> m_left;
-    const Token m_op;
-    const std::shared_ptr<Expr> m_right;
+    Expr* m_left;
+    SlimToken const m_op;
+    Expr* m_right;
 };
 
-inline std::shared_ptr<Expr> make_binary(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right) {
-    return std::make_shared<Binary>(left, op, right);
+inline Binary* make_binary(Arena& arena, Expr* left, SlimToken op, Expr* right) {
+    return arena.make<Binary>(left, op, right);
 }
 
 struct Call : public Expr {
-    Call(std::shared_ptr<Expr> callee, Token paren, std::vector<std::shared_ptr<Expr>> arguments) :
+    Call(Expr* callee, SlimToken paren, ArenaList<Expr*> arguments) :
         m_callee(callee),
         m_paren(paren),
-        m_arguments(arguments)
+        m_arguments(arguments),
+        m_cache()
     {}
 
-    virtual ~Call() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitCallExpr(this);
     }
 
-    const std::shared_ptr<Expr> m_callee;
-    const Token m_paren;
-    const std::vector<std::shared_ptr<Expr>> m_arguments;
+    Expr* m_callee;
+    SlimToken const m_paren;
+    ArenaList<Expr*> m_arguments;
+    InlineCache m_cache;
 };
 
-inline std::shared_ptr<Expr> make_call(std::shared_ptr<Expr> callee, Token paren, std::vector<std::shared_ptr<Expr>> arguments) {
-    return std::make_shared<Call>(callee, paren, arguments);
+inline Call* make_call(Arena& arena, Expr* callee, SlimToken paren, ArenaList<Expr*> arguments) {
+    return arena.make<Call>(callee, paren, arguments);
 }
 
 struct Get : public Expr {
-    Get(std::shared_ptr<Expr> object, Token name) :
+    Get(Expr* object, SlimToken name) :
         m_object(object),
-        m_name(name)
+        m_name(name),
+        m_cache()
     {}
 
-    virtual ~Get() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitGetExpr(this);
     }
 
-    const std::shared_ptr<Expr> m_object;
-    const Token m_name;
+    Expr* m_object;
+    SlimToken const m_name;
+    InlineCache m_cache;
 };
 
-inline std::shared_ptr<Expr> make_get(std::shared_ptr<Expr> object, Token name) {
-    return std::make_shared<Get>(object, name);
+inline Get* make_get(Arena& arena, Expr* object, SlimToken name) {
+    return arena.make<Get>(object, name);
 }
 
 struct Set : public Expr {
-    Set(std::shared_ptr<Expr> object, Token name, std::shared_ptr<Expr> value) :
+    Set(Expr* object, SlimToken name, Expr* value) :
         m_object(object),
         m_name(name),
-        m_value(value)
+        m_value(value),
+        m_cache()
     {}
 
-    virtual ~Set() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitSetExpr(this);
     }
 
-    const std::shared_ptr<Expr> m_object;
-    const Token m_name;
-    const std::shared_ptr<Expr> m_value;
+    Expr* m_object;
+    SlimToken const m_name;
+    Expr* m_value;
+    InlineCache m_cache;
 };
 
-inline std::shared_ptr<Expr> make_set(std::shared_ptr<Expr> object, Token name, std::shared_ptr<Expr> value) {
-    return std::make_shared<Set>(object, name, value);
+inline Set* make_set(Arena& arena, Expr* object, SlimToken name, Expr* value) {
+    return arena.make<Set>(object, name, value);
 }
 
 struct Super : public Expr {
-    Super(Token keyword, Token method) :
+    Super(SlimToken keyword, SlimToken method) :
         m_keyword(keyword),
-        m_method(method)
+        m_method(method),
+        m_resolution(),
+        m_thisResolution()
     {}
 
-    virtual ~Super() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitSuperExpr(this);
     }
 
-    const Token m_keyword;
-    const Token m_method;
+    SlimToken const m_keyword;
+    SlimToken const m_method;
+    Resolution m_resolution;
+    Resolution m_thisResolution;
 };
 
-inline std::shared_ptr<Expr> make_super(Token keyword, Token method) {
-    return std::make_shared<Super>(keyword, method);
+inline Super* make_super(Arena& arena, SlimToken keyword, SlimToken method) {
+    return arena.make<Super>(keyword, method);
 }
 
 struct This : public Expr {
-    This(Token keyword) :
-        m_keyword(keyword)
+    This(SlimToken keyword) :
+        m_keyword(keyword),
+        m_resolution()
     {}
 
-    virtual ~This() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitThisExpr(this);
     }
 
-    const Token m_keyword;
+    SlimToken const m_keyword;
+    Resolution m_resolution;
 };
 
-inline std::shared_ptr<Expr> make_this(Token keyword) {
-    return std::make_shared<This>(keyword);
+inline This* make_this(Arena& arena, SlimToken keyword) {
+    return arena.make<This>(keyword);
 }
 
 struct Grouping : public Expr {
-    Grouping(std::shared_ptr<Expr> expression) :
+    Grouping(Expr* expression) :
         m_expression(expression)
     {}
 
-    virtual ~Grouping() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitGroupingExpr(this);
     }
 
-    const std::shared_ptr<Expr> m_expression;
+    Expr* m_expression;
 };
 
-inline std::shared_ptr<Expr> make_grouping(std::shared_ptr<Expr> expression) {
-    return std::make_shared<Grouping>(expression);
+inline Grouping* make_grouping(Arena& arena, Expr* expression) {
+    return arena.make<Grouping>(expression);
 }
 
 struct Literal : public Expr {
-    Literal(std::any value) :
+    Literal(Value value) :
         m_value(value)
     {}
 
-    virtual ~Literal() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitLiteralExpr(this);
     }
 
-    const std::any m_value;
+    Value const m_value;
 };
 
-inline std::shared_ptr<Expr> make_literal(std::any value) {
-    return std::make_shared<Literal>(value);
+inline Literal* make_literal(Arena& arena, Value value) {
+    return arena.make<Literal>(value);
 }
 
 struct Logical : public Expr {
-    Logical(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right) :
+    Logical(Expr* left, SlimToken op, Expr* right) :
         m_left(left),
         m_op(op),
         m_right(right)
     {}
 
-    virtual ~Logical() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitLogicalExpr(this);
     }
 
-    const std::shared_ptr<Expr> m_left;
-    const Token m_op;
-    const std::shared_ptr<Expr> m_right;
+    Expr* m_left;
+    SlimToken const m_op;
+    Expr* m_right;
 };
 
-inline std::shared_ptr<Expr> make_logical(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right) {
-    return std::make_shared<Logical>(left, op, right);
+inline Logical* make_logical(Arena& arena, Expr* left, SlimToken op, Expr* right) {
+    return arena.make<Logical>(left, op, right);
 }
 
 struct Unary : public Expr {
-    Unary(Token op, std::shared_ptr<Expr> right) :
+    Unary(SlimToken op, Expr* right) :
         m_op(op),
         m_right(right)
     {}
 
-    virtual ~Unary() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitUnaryExpr(this);
     }
 
-    const Token m_op;
-    const std::shared_ptr<Expr> m_right;
+    SlimToken const m_op;
+    Expr* m_right;
 };
 
-inline std::shared_ptr<Expr> make_unary(Token op, std::shared_ptr<Expr> right) {
-    return std::make_shared<Unary>(op, right);
+inline Unary* make_unary(Arena& arena, SlimToken op, Expr* right) {
+    return arena.make<Unary>(op, right);
 }
 
 struct Comma : public Expr {
-    Comma(std::vector<std::shared_ptr<Expr>> exprs, std::shared_ptr<Expr> last) :
+    Comma(ArenaList<Expr*> exprs, Expr* last) :
         m_exprs(exprs),
         m_last(last)
     {}
 
-    virtual ~Comma() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitCommaExpr(this);
     }
 
-    const std::vector<std::shared_ptr<Expr>> m_exprs;
-    const std::shared_ptr<Expr> m_last;
+    ArenaList<Expr*> m_exprs;
+    Expr* m_last;
 };
 
-inline std::shared_ptr<Expr> make_comma(std::vector<std::shared_ptr<Expr>> exprs, std::shared_ptr<Expr> last) {
-    return std::make_shared<Comma>(exprs, last);
+inline Comma* make_comma(Arena& arena, ArenaList<Expr*> exprs, Expr* last) {
+    return arena.make<Comma>(exprs, last);
 }
 
 struct Variable : public Expr {
-    Variable(Token name) :
-        m_name(name)
+    Variable(SlimToken name) :
+        m_name(name),
+        m_resolution()
     {}
 
-    virtual ~Variable() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitVariableExpr(this);
     }
 
-    const Token m_name;
+    SlimToken const m_name;
+    Resolution m_resolution;
 };
 
-inline std::shared_ptr<Expr> make_variable(Token name) {
-    return std::make_shared<Variable>(name);
+inline Variable* make_variable(Arena& arena, SlimToken name) {
+    return arena.make<Variable>(name);
 }
 
 struct Input : public Expr {
@@ -308,17 +300,15 @@ struct Input : public Expr {
         m_e(e)
     {}
 
-    virtual ~Input() = default;
-
-    std::any accept(Visitor* visitor) {
+    Value accept(Visitor* visitor) {
         return visitor->visitInputExpr(this);
     }
 
-    const void* m_e;
+    void* m_e;
 };
 
-inline std::shared_ptr<Expr> make_input(void* e) {
-    return std::make_shared<Input>(e);
+inline Input* make_input(Arena& arena, void* e) {
+    return arena.make<Input>(e);
 }
 
 }
@@ -3,27 +3,29 @@
 
 #include "nex_stmt.hpp"
 #include "nex_callable.hpp"
-#include "nex_environment.hpp"
-#include "nex_return.hpp"
+#include "nex_cell.hpp"
 #include "nex_instance.hpp"
 #include "nex_interpreter.hpp"
 
-#include <any>
 #include <string>
 #include <vector>
-#include <memory>
 
 namespace nex {
 
 class NexFunction : public NexCallable
 {
 public:
+    // 'upvalues' are the cells of the variables the function captured, in
+    // the order of its declaration's m_captures. Methods bound to an
+    // instance have it as 'receiver'.
     NexFunction(const stmt::Function& declaration,
-                std::shared_ptr<Environment> closure,
-                bool bIsInitializer)
+                HeapVector<Ref<Cell>> upvalues,
+                bool bIsInitializer,
+                Ref<NexInstance> receiver = nullptr)
         : m_declaration(declaration)
-        , m_pClosure(closure)
+        , m_upvalues(std::move(upvalues))
         , m_bIsInitializer(bIsInitializer)
+        , m_pReceiver(receiver)
     {}
 
     virtual ~NexFunction() = default;
@@ -33,58 +35,70 @@ public:
         return m_declaration.m_params.size();
     }
 
-    inline std::any call(Interpreter* interp, std::vector<std::any> arguments) override
+    inline Value call(Interpreter* interp, Arguments arguments) override
     {
-        auto localEnv =
-            std::make_shared<Environment>(L"<func " + m_declaration.m_name.m_lexeme + L">");
-        localEnv->copy(m_pClosure);
+        return interp->executeFunction(this, m_pReceiver.get(), arguments);
+    }
 
-        for (size_t idx = 0; idx < m_declaration.m_params.size(); idx++) {
-            localEnv->define(m_declaration.m_params.at(idx), arguments.at(idx));
-        }
+    // Calls the method with 'this' bound to 'instance', without allocating
+    // the bound function bind() would return
+    inline Value callMethod(Interpreter* interp,
+                            NexInstance* instance,
+                            Arguments arguments)
+    {
+        return interp->executeFunction(this, instance, arguments);
+    }
 
-        localEnv->dump();
+    inline std::string to_string() const override
+    {
+        return "<func '" + m_declaration.m_name.lexeme() + "'>";
+    }
 
-        try {
-            interp->executeBlock(m_declaration.m_body, localEnv);
-        } catch (const NexReturn& e) {
-            if (m_bIsInitializer) {
-                return m_pClosure->getAt(0, L"this");
-            }
-            return e.m_value;
-        }
+    inline Ref<NexFunction> bind(NexInstance* instance)
+    {
+        return Heap::make<NexFunction>(m_declaration, m_upvalues, m_bIsInitializer, instance);
+    }
 
-        if (m_bIsInitializer) {
-            return m_pClosure->getAt(0, L"this");
-        }
+    inline std::string name() const override {
+        return m_declaration.m_name.lexeme();
+    }
+
+    inline const stmt::Function& declaration() const
+    {
+        return m_declaration;
+    }
 
-        return nullptr;
+    inline const HeapVector<Ref<Cell>>& upvalues() const
+    {
+        return m_upvalues;
     }
 
-    inline std::wstring to_string() const override
+    inline bool isInitializer() const
     {
-        return L"<func '" + m_declaration.m_name.m_lexeme + L"'>";
+        return m_bIsInitializer;
     }
 
-    inline std::shared_ptr<NexFunction> bind(std::shared_ptr<NexInstance> instance)
+    inline void trace(Tracer& tracer) override
     {
-        auto env = std::make_shared<Environment>(m_declaration.m_name.m_lexeme);
-        env->copy(m_pClosure);
-        Token tthis(THIS, L"this", nullptr, 0);
-        env->define(tthis, instance);
-        return std::make_shared<NexFunction>(m_declaration, env, m_bIsInitializer);
+        for (const auto& cell : m_upvalues) {
+            tracer.visit(cell);
+        }
+        tracer.visit(m_pReceiver);
     }
 
-    inline std::wstring name() const override {
-        return m_declaration.m_name.m_lexeme;
+    inline void clear() override
+    {
+        m_upvalues.clear();
+        m_pReceiver = nullptr;
     }
 
 private:
     const stmt::Function& m_declaration;
-    std::shared_ptr<Environment> m_pClosure;
+    HeapVector<Ref<Cell>> m_upvalues;
     bool m_bIsInitializer;
+    Ref<NexInstance> m_pReceiver;
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,49 @@
+#include "nex_globals.hpp"
+#include "nex_runtime_error.hpp"
+
+namespace nex {
+
+uint32_t GlobalTable::indexOf(Symbol name)
+{
+    auto& table = indices();
+    return table.emplace(name, static_cast<uint32_t>(table.size())).first->second;
+}
+
+void GlobalTable::defineNative(const SlimToken& name, Value value)
+{
+    auto& global = at(indexOf(name.m_symbol));
+    global.value = std::move(value);
+    global.state = NATIVE;
+}
+
+void GlobalTable::define(const SlimToken& name, Value value)
+{
+    auto& global = at(indexOf(name.m_symbol));
+    if (global.state == DECLARED) {
+        throw NexRunTimeError(name, "Symbol '" + name.lexeme() + "' has already been declared");
+    }
+
+    global.value = std::move(value);
+    global.state = DECLARED;
+}
+
+GlobalTable::Global& GlobalTable::at(uint32_t index)
+{
+    if (index >= m_globals.size()) {
+        m_globals.resize(index + 1);
+    }
+    return m_globals[index];
+}
+
+void GlobalTable::undefined(const SlimToken& name)
+{
+    throw NexRunTimeError(name, "Undefined symbol '" + name.lexeme() + "'.");
+}
+
+std::unordered_map<Symbol, uint32_t>& GlobalTable::indices()
+{
+    static std::unordered_map<Symbol, uint32_t> s_indices;
+    return s_indices;
+}
+
+}
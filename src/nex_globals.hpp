@@ -0,0 +1,75 @@
+#ifndef NEX_GLOBALS_HPP
+#define NEX_GLOBALS_HPP
+
+#include "nex_symbol.hpp"
+#include "nex_token.hpp"
+#include "nex_value.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace nex {
+
+// Global variables of an interpreter, stored by index. Every global name
+// gets its index once, process wide, when the Resolver meets it, so reads
+// and writes at runtime never hash the name.
+class GlobalTable final
+{
+public:
+    GlobalTable()
+        : m_globals()
+    {}
+
+    ~GlobalTable() = default;
+
+    // The index of the global 'name', the same in every table
+    static uint32_t indexOf(Symbol name);
+
+    // Declares a native function, a script may declare the name once more
+    // to replace it
+    void defineNative(const SlimToken& name, Value value);
+
+    void define(const SlimToken& name, Value value);
+
+    inline const Value& get(const SlimToken& name, uint32_t index) const
+    {
+        if (index < m_globals.size() && m_globals[index].state != UNDEFINED) {
+            return m_globals[index].value;
+        }
+        undefined(name);
+    }
+
+    inline void assign(const SlimToken& name, uint32_t index, Value value)
+    {
+        if (index < m_globals.size() && m_globals[index].state != UNDEFINED) {
+            m_globals[index].value = std::move(value);
+            return;
+        }
+        undefined(name);
+    }
+
+private:
+    enum State : uint8_t {
+        UNDEFINED,
+        NATIVE,
+        DECLARED,
+    };
+
+    struct Global {
+        Value value;
+        State state = UNDEFINED;
+    };
+
+    Global& at(uint32_t index);
+
+    [[noreturn]] static void undefined(const SlimToken& name);
+
+    static std::unordered_map<Symbol, uint32_t>& indices();
+
+    std::vector<Global> m_globals;
+};
+
+}
+
+#endif
@@ -0,0 +1,191 @@
+#include "nex_heap.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace nex {
+
+HeapObject::~HeapObject()
+{
+    if (tracked()) {
+        Heap::instance().untrack(this);
+    }
+}
+
+Heap::Heap()
+    : m_config()
+    , m_stats()
+    , m_pObjects(nullptr)
+    , m_bCollecting(false)
+    , m_freeBlocks()
+    , m_pChunkNext(nullptr)
+    , m_pChunkEnd(nullptr)
+    , m_chunks()
+{
+    m_stats.nextCollection = m_config.initialThreshold;
+}
+
+size_t Heap::collect()
+{
+    return instance().collectGarbage();
+}
+
+void Heap::configure(const Config& config)
+{
+    auto& heap = instance();
+    heap.m_config = config;
+    heap.m_stats.nextCollection = config.initialThreshold;
+}
+
+const Heap::Stats& Heap::stats()
+{
+    return instance().m_stats;
+}
+
+Heap& Heap::instance()
+{
+    // Never destroyed, objects may still be released while the program exits
+    static auto s_pHeap = new Heap();
+    return *s_pHeap;
+}
+
+void* Heap::carve(size_t sizeClass)
+{
+    auto blockSize = (sizeClass + 1) * GRANULE;
+    if (m_pChunkNext + blockSize > m_pChunkEnd) {
+        // What is left of the chunk, smaller than a block, goes to the free
+        // list of its own size
+        if (m_pChunkNext != m_pChunkEnd) {
+            deallocate(m_pChunkNext, static_cast<size_t>(m_pChunkEnd - m_pChunkNext));
+        }
+
+        m_pChunkNext = static_cast<uint8_t*>(::operator new(CHUNK_SIZE));
+        m_pChunkEnd = m_pChunkNext + CHUNK_SIZE;
+        m_chunks.push_back(m_pChunkNext);
+    }
+
+    auto pBlock = m_pChunkNext;
+    m_pChunkNext += blockSize;
+    return pBlock;
+}
+
+void Heap::track(HeapObject* pObject, size_t size)
+{
+    pObject->m_bTracked = true;
+    pObject->m_size = static_cast<uint32_t>(size);
+    pObject->m_pNext = m_pObjects;
+    if (m_pObjects) {
+        m_pObjects->m_pPrev = pObject;
+    }
+    m_pObjects = pObject;
+
+    m_stats.bytesAllocated += size;
+    m_stats.bytesLive += size;
+    m_stats.objectsLive++;
+}
+
+void Heap::untrack(HeapObject* pObject)
+{
+    if (pObject->m_pPrev) {
+        pObject->m_pPrev->m_pNext = pObject->m_pNext;
+    }
+    else {
+        m_pObjects = pObject->m_pNext;
+    }
+    if (pObject->m_pNext) {
+        pObject->m_pNext->m_pPrev = pObject->m_pPrev;
+    }
+
+    m_stats.bytesLive -= pObject->m_size;
+    m_stats.objectsLive--;
+}
+
+size_t Heap::collectGarbage()
+{
+    if (m_bCollecting) {
+        return 0;
+    }
+    m_bCollecting = true;
+
+    // References from outside the heap are what is left of the reference
+    // counts once the heap's own references are taken out
+    class InternalRefs final : public Tracer
+    {
+    public:
+        using Tracer::visit;
+
+        inline void visit(Object* pObject) override
+        {
+            if (pObject->tracked()) {
+                static_cast<HeapObject*>(pObject)->m_gcRefs--;
+            }
+        }
+    } internalRefs;
+
+    for (auto pObject = m_pObjects; pObject; pObject = pObject->m_pNext) {
+        pObject->m_gcRefs = static_cast<int32_t>(pObject->refCount());
+        pObject->m_bMarked = false;
+    }
+    for (auto pObject = m_pObjects; pObject; pObject = pObject->m_pNext) {
+        pObject->trace(internalRefs);
+    }
+
+    // Mark everything reachable from the objects referenced from outside
+    class Marker final : public Tracer
+    {
+    public:
+        using Tracer::visit;
+
+        inline void visit(Object* pObject) override
+        {
+            if (!pObject->tracked()) {
+                return;
+            }
+
+            auto pHeapObject = static_cast<HeapObject*>(pObject);
+            if (!pHeapObject->m_bMarked) {
+                pHeapObject->m_bMarked = true;
+                m_pending.push_back(pHeapObject);
+            }
+        }
+
+        std::vector<HeapObject*> m_pending;
+    } marker;
+
+    for (auto pObject = m_pObjects; pObject; pObject = pObject->m_pNext) {
+        if (pObject->m_gcRefs > 0) {
+            pObject->m_bMarked = true;
+            marker.m_pending.push_back(pObject);
+        }
+    }
+    while (!marker.m_pending.empty()) {
+        auto pObject = marker.m_pending.back();
+        marker.m_pending.pop_back();
+        pObject->trace(marker);
+    }
+
+    // The rest is garbage. It is kept alive while every object drops its
+    // references, then released all at once.
+    std::vector<Ref<HeapObject>> garbage;
+    for (auto pObject = m_pObjects; pObject; pObject = pObject->m_pNext) {
+        if (!pObject->m_bMarked) {
+            garbage.emplace_back(pObject);
+        }
+    }
+    for (auto& object : garbage) {
+        object->clear();
+    }
+    auto collected = garbage.size();
+    garbage.clear();
+
+    m_stats.collections++;
+    m_stats.objectsCollected += collected;
+    m_stats.nextCollection = std::max(
+        m_config.initialThreshold,
+        static_cast<size_t>(m_stats.bytesLive * m_config.growthFactor));
+
+    m_bCollecting = false;
+    return collected;
+}
+
+}
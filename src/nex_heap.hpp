@@ -0,0 +1,252 @@
+#ifndef NEX_HEAP_HPP
+#define NEX_HEAP_HPP
+
+#include "nex_object.hpp"
+#include "nex_value.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace nex {
+
+// Receives the references a HeapObject holds, see HeapObject::trace
+class Tracer
+{
+public:
+    virtual ~Tracer() = default;
+
+    virtual void visit(Object* pObject) = 0;
+
+    inline void visit(const Value& value)
+    {
+        if (value.isObject()) {
+            visit(value.asObject());
+        }
+    }
+
+    template <typename T>
+    inline void visit(const Ref<T>& ref)
+    {
+        if (ref) {
+            visit(static_cast<Object*>(ref.get()));
+        }
+    }
+};
+
+// Object that can be part of a reference cycle: cells, functions, classes
+// and instances. Allocated with Heap::make, out of the heap's pool.
+class HeapObject : public Object
+{
+public:
+    HeapObject() = default;
+    virtual ~HeapObject();
+
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size);
+
+    // Passes every reference the object owns (the ones it retained) to
+    // 'tracer', and nothing else
+    virtual void trace(Tracer& tracer) = 0;
+
+    // Drops every reference the object owns, to break a garbage cycle
+    virtual void clear() = 0;
+
+private:
+    friend class Heap;
+
+    HeapObject* m_pPrev = nullptr;
+    HeapObject* m_pNext = nullptr;
+    uint32_t m_size = 0;
+    int32_t m_gcRefs = 0;
+    bool m_bMarked = false;
+};
+
+// Owner of the HeapObjects of the process. Reference counting frees most
+// objects as soon as they are unreachable, the heap collects the cycles it
+// cannot free with a mark-sweep pass:
+//
+//  1. The roots are the objects referenced from outside the heap: the
+//     interpreter's frames and globals, the VM stack, values held by the
+//     C++ code running at the time. They are found by subtracting the
+//     references heap objects hold on each other from the reference counts.
+//  2. Everything reachable from the roots is marked.
+//  3. Unmarked objects are only reachable from each other. They drop their
+//     references and the cycles fall apart.
+//
+// A collection runs from make() once the live bytes reach the threshold,
+// which then becomes the live bytes left times the growth factor, and never
+// less than the initial threshold. Only garbage cycles make the live bytes
+// grow without bound, programs without cycles rarely collect.
+//
+// Memory comes from a pool of size classes, multiples of 16 bytes up to
+// MAX_POOLED. A block is carved from the current chunk by bumping a pointer
+// and goes back to the free list of its class when it is freed, where the
+// next allocation of that size picks it up. Short lived objects (a bound
+// method, the cell of a loop variable, a temporary instance) keep reusing
+// the same few blocks instead of going through malloc. Chunks are never
+// given back, the pool stays as large as the most memory the program used.
+class Heap final
+{
+public:
+    struct Config {
+        size_t initialThreshold = 1024 * 1024;
+        double growthFactor = 2.0;
+    };
+
+    struct Stats {
+        // Bytes of all the objects ever allocated, and of the live ones
+        size_t bytesAllocated = 0;
+        size_t bytesLive = 0;
+        size_t objectsLive = 0;
+        size_t collections = 0;
+        // Objects freed by collections (reference counting frees the rest)
+        size_t objectsCollected = 0;
+        size_t nextCollection = 0;
+    };
+
+    template <typename T, typename ...Args>
+    static Ref<T> make(Args&& ...args)
+    {
+        auto& heap = instance();
+        if (heap.m_stats.bytesLive >= heap.m_stats.nextCollection) {
+            heap.collectGarbage();
+        }
+
+        auto pObject = new T(std::forward<Args>(args)...);
+        heap.track(pObject, sizeof(T));
+        return Ref<T>(pObject);
+    }
+
+    // Collects now, returns the number of objects freed
+    static size_t collect();
+
+    // Raw memory from the pool, 'size' must be the same in both calls
+    static inline void* allocate(size_t size)
+    {
+        if (size > MAX_POOLED) {
+            return ::operator new(size);
+        }
+
+        auto& heap = instance();
+        auto& pFree = heap.m_freeBlocks[sizeClass(size)];
+        if (auto pBlock = pFree) {
+            pFree = pBlock->pNext;
+            return pBlock;
+        }
+        return heap.carve(sizeClass(size));
+    }
+
+    static inline void deallocate(void* p, size_t size)
+    {
+        if (size > MAX_POOLED) {
+            ::operator delete(p);
+            return;
+        }
+
+        auto& pFree = instance().m_freeBlocks[sizeClass(size)];
+        auto pBlock = static_cast<FreeBlock*>(p);
+        pBlock->pNext = pFree;
+        pFree = pBlock;
+    }
+
+    static void configure(const Config& config);
+
+    static const Stats& stats();
+
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t MAX_POOLED = 512;
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+private:
+    friend class HeapObject;
+
+    struct FreeBlock {
+        FreeBlock* pNext;
+    };
+
+    static constexpr size_t SIZE_CLASSES = MAX_POOLED / GRANULE;
+
+    Heap();
+
+    static Heap& instance();
+
+    static inline size_t sizeClass(size_t size)
+    {
+        return size ? (size - 1) / GRANULE : 0;
+    }
+
+    // New block of 'sizeClass' taken from the current chunk
+    void* carve(size_t sizeClass);
+
+    void track(HeapObject* pObject, size_t size);
+    void untrack(HeapObject* pObject);
+    size_t collectGarbage();
+
+    Config m_config;
+    Stats m_stats;
+    // Every tracked object, in a doubly linked list
+    HeapObject* m_pObjects;
+    bool m_bCollecting;
+
+    FreeBlock* m_freeBlocks[SIZE_CLASSES];
+    // Unused end of the current chunk
+    uint8_t* m_pChunkNext;
+    uint8_t* m_pChunkEnd;
+    std::vector<void*> m_chunks;
+};
+
+// Allocator for the containers of heap objects (slots, fields), so their
+// storage comes from the pool as well
+template <typename T>
+class HeapAllocator
+{
+public:
+    using value_type = T;
+
+    HeapAllocator() = default;
+
+    template <typename U>
+    HeapAllocator(const HeapAllocator<U>&) {}
+
+    inline T* allocate(size_t count)
+    {
+        return static_cast<T*>(Heap::allocate(count * sizeof(T)));
+    }
+
+    inline void deallocate(T* p, size_t count)
+    {
+        Heap::deallocate(p, count * sizeof(T));
+    }
+
+    template <typename U>
+    inline bool operator==(const HeapAllocator<U>&) const
+    {
+        return true;
+    }
+
+    template <typename U>
+    inline bool operator!=(const HeapAllocator<U>&) const
+    {
+        return false;
+    }
+};
+
+template <typename T>
+using HeapVector = std::vector<T, HeapAllocator<T>>;
+
+inline void* HeapObject::operator new(size_t size)
+{
+    return Heap::allocate(size);
+}
+
+inline void HeapObject::operator delete(void* p, size_t size)
+{
+    Heap::deallocate(p, size);
+}
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef NEX_INLINE_CACHE_HPP
+#define NEX_INLINE_CACHE_HPP
+
+#include "nex_object.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nex {
+
+// Result of looking up a property on instances of one shape (a NexClass).
+// Shapes are never reused, so a slot stays valid for as long as instances
+// of its shape are alive.
+struct PropertySlot {
+    enum Kind : uint8_t {
+        NONE,
+        FIELD,
+        METHOD,
+    };
+
+    uint32_t shape;
+    Kind kind;
+    // Offset in the instance fields when kind is FIELD
+    uint32_t field;
+    // The NexFunction when kind is METHOD, owned by the class
+    Object* pMethod;
+};
+
+// Polymorphic inline cache carried by Get, Set and Call sites. It remembers
+// the lookups of the first CAPACITY shapes seen at the site, sites that see
+// more shapes than that go through the class for the rest.
+class InlineCache final
+{
+public:
+    static constexpr size_t CAPACITY = 4;
+
+    InlineCache()
+        : m_entries()
+        , m_count(0)
+    {}
+
+    inline const PropertySlot* find(uint32_t shape) const
+    {
+        for (size_t idx = 0; idx < m_count; idx++) {
+            if (m_entries[idx].shape == shape) {
+                return &m_entries[idx];
+            }
+        }
+        return nullptr;
+    }
+
+    inline void add(const PropertySlot& slot)
+    {
+        if (m_count < CAPACITY) {
+            m_entries[m_count++] = slot;
+        }
+    }
+
+private:
+    PropertySlot m_entries[CAPACITY];
+    size_t m_count;
+};
+
+}
+
+#endif
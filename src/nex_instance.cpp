@@ -4,41 +4,70 @@
 
 namespace nex {
 
-NexInstance::NexInstance(NexClass* pKlass,
-                         std::map<std::wstring, std::any> fields)
+NexInstance::NexInstance(Ref<NexClass> pKlass,
+                         HeapVector<Value> fields)
     : m_pKlass(pKlass)
-    , m_fields(fields)
+    , m_fields(std::move(fields))
 {}
 
-std::wstring NexInstance::to_string()
+void NexInstance::trace(Tracer& tracer)
 {
-    return L"<'" + m_pKlass->m_name + L"' instance>";
+    tracer.visit(m_pKlass);
+    for (const auto& field : m_fields) {
+        tracer.visit(field);
+    }
+}
+
+void NexInstance::clear()
+{
+    m_pKlass = nullptr;
+    m_fields.clear();
 }
 
-std::any NexInstance::get(Token const& name)
+std::string NexInstance::to_string()
 {
-    if (m_fields.count(name.m_lexeme)) {
-        return m_fields[name.m_lexeme];
+    return "<'" + m_pKlass->m_name + "' instance>";
+}
+
+Value NexInstance::get(SlimToken const& name, InlineCache& cache)
+{
+    auto slot = lookup(name, cache);
+    switch (slot.kind) {
+    case PropertySlot::FIELD:
+        return m_fields[slot.field];
+    case PropertySlot::METHOD:
+        return static_cast<NexFunction*>(slot.pMethod)->bind(this);
+    default:
+        undefinedProperty(name);
     }
+}
 
-    if (auto pMethod = m_pKlass->findMethod(name.m_lexeme)) {
-        std::shared_ptr<NexInstance> tthis(this, [](NexInstance*){});
-        return std::dynamic_pointer_cast<NexCallable>(pMethod->bind(tthis));
+Value NexInstance::set(SlimToken const& name, Value const& value, InlineCache& cache)
+{
+    auto slot = lookup(name, cache);
+    if (slot.kind == PropertySlot::FIELD) {
+        m_fields[slot.field] = value;
+        return value;
     }
 
-    throw NexRunTimeError(name,
-        m_pKlass->m_name + L" object has not property '" + name.m_lexeme + L"'");
+    undefinedProperty(name);
 }
 
-std::any NexInstance::set(Token const& name, std::any const& value)
+PropertySlot NexInstance::lookup(SlimToken const& name, InlineCache& cache)
 {
-    if (m_fields.count(name.m_lexeme)) {
-        m_fields[name.m_lexeme] = value;
-        return value;
+    if (auto pSlot = cache.find(m_pKlass->m_shape)) {
+        return *pSlot;
     }
 
+    auto slot = m_pKlass->findProperty(name.m_symbol);
+    cache.add(slot);
+    return slot;
+}
+
+void NexInstance::undefinedProperty(SlimToken const& name)
+{
     throw NexRunTimeError(name,
-        m_pKlass->m_name + L" object has not property '" + name.m_lexeme + L"'");
+        m_pKlass->m_name + " object has not property '" + name.lexeme() + "'");
 }
 
 }
@@ -1,32 +1,64 @@
 #ifndef NEX_NEX_INSTANCE_HPP
 #define NEX_NEX_INSTANCE_HPP
 
+#include "nex_inline_cache.hpp"
+#include "nex_heap.hpp"
 #include "nex_token.hpp"
+#include "nex_value.hpp"
 
 #include <string>
-#include <map>
 #include <memory>
+#include <vector>
 
 namespace nex {
 class NexClass;
 
-class NexInstance
+class NexInstance : public HeapObject
 {
 public:
-    NexInstance() = default;
-    NexInstance(NexClass* pKlass, std::map<std::wstring, std::any> fields);
+    // 'fields' are laid out as described by the class' m_fieldSlots
+    NexInstance(Ref<NexClass> pKlass, HeapVector<Value> fields);
 
-    ~NexInstance() = default;
+    virtual ~NexInstance() = default;
 
-    std::wstring to_string();
+    std::string to_string();
 
-    std::any get(Token const& name);
-    std::any set(Token const& name, std::any const& value);
+    // Property access from a Get or Set site, 'cache' is the site's cache
+    Value get(SlimToken const& name, InlineCache& cache);
+    Value set(SlimToken const& name, Value const& value, InlineCache& cache);
+
+    // Where 'name' lives on this instance. Served from 'cache' when it has
+    // already seen the class, otherwise asks the class and fills the cache.
+    PropertySlot lookup(SlimToken const& name, InlineCache& cache);
+
+    inline NexClass* klass() const
+    {
+        return m_pKlass.get();
+    }
+
+    inline Value& field(size_t offset)
+    {
+        return m_fields[offset];
+    }
+
+    void trace(Tracer& tracer) override;
+    void clear() override;
 
 private:
-    NexClass* m_pKlass;
-    std::map<std::wstring, std::any> m_fields;
+    [[noreturn]] void undefinedProperty(SlimToken const& name);
+
+    Ref<NexClass> m_pKlass;
+    HeapVector<Value> m_fields;
 };
 
+inline Value::Value(NexInstance* pInstance)
+    : Value(ValueType::INSTANCE, pInstance)
+{}
+
+inline NexInstance* Value::asInstance() const
+{
+    return static_cast<NexInstance*>(m_as.pObject);
+}
+
 }
-#endif
\ No newline at end of file
+#endif
@@ -7,7 +7,6 @@
 #include "nex_class.hpp"
 #include "nex_instance.hpp"
 #include "nex_runtime_error.hpp"
-#include "nex_return.hpp"
 
 namespace nex {
 
@@ -15,22 +14,28 @@ using namespace nex::runtime;
 
 Interpreter::Interpreter()
     : m_bHadRuntimeError(false)
-    , m_pEnv(std::make_shared<Environment>(L"local"))
-    , m_pGlobals(std::make_shared<Environment>(L"global"))
-    , m_locals()
-{
-    // Insert native functions to the global environment
-#define EMIT_NATIVE_FN(id, symbol)      \
-    m_pGlobals->define(id, std::make_any<std::shared_ptr<NexCallable>>(std::make_shared<SystemClock>()));
+    , m_stack(STACK_MAX)
+    , m_frame{ m_stack.data(), m_stack.data(), nullptr }
+    , m_callDepth(0)
+    , m_globals()
+    , m_completion(Completion::NORMAL)
+    , m_returnValue()
+{
+    // Insert native functions to the global table, top level declarations
+    // may replace them
+#define EMIT_NATIVE_FN(name, function)  \
+    defineNative<function>(name);
     NATIVE_FN_LIST
 #undef EMIT_NATIVE_FN
+}
 
-    // Copy the global environment into the interpreter's current stack environment
-    m_pEnv->copy(m_pGlobals);
-    m_pEnv->dump();
+void Interpreter::defineNative(Ref<NativeFunction> function)
+{
+    SlimToken name(IDENTIFIER, SymbolTable::intern(function->name()), 0);
+    m_globals.defineNative(name, function);
 }
 
-void Interpreter::interpret(std::vector<std::shared_ptr<stmt::Stmt>> stmts)
+void Interpreter::interpret(ArenaList<stmt::Stmt*> stmts)
 {
     try {
         for (auto s : stmts) {
@@ -38,32 +43,37 @@ void Interpreter::interpret(std::vector<std::shared_ptr<stmt::Stmt>> stmts)
         }
     } catch (const NexRunTimeError& e) {
         m_bHadRuntimeError = true;
+        m_completion = Completion::NORMAL;
         runtimeError(e);
     }
+
+    // Back to an empty top level frame, an error leaves the frames of the
+    // calls it interrupted behind and the innermost one ends highest
+    Frame top{ m_stack.data(), m_stack.data(), nullptr };
+    m_frame.pSlots = m_stack.data();
+    popFrame(top);
+    m_callDepth = 0;
 }
 
-void Interpreter::execute(std::shared_ptr<stmt::Stmt> s)
+void Interpreter::execute(stmt::Stmt* s)
 {
     s->accept(this);
 }
 
 
-std::any Interpreter::visitAssignExpr(expr::Assign* expr)
+Value Interpreter::visitAssignExpr(expr::Assign* expr)
 {
     auto value = evaluate(expr->m_value);
-    if (m_locals.count(expr)) {
-        auto distance = m_locals[expr];
-        m_pEnv->assignAt(distance, expr->m_name, value);
-    }
+    assign(expr->m_name, expr->m_resolution, value);
     return value;
 }
 
-std::any Interpreter::visitLiteralExpr(expr::Literal* expr)
+Value Interpreter::visitLiteralExpr(expr::Literal* expr)
 {
     return expr->m_value;
 }
 
-std::any Interpreter::visitLogicalExpr(expr::Logical* expr)
+Value Interpreter::visitLogicalExpr(expr::Logical* expr)
 {
     auto left = evaluate(expr->m_left);
     if (expr->m_op.m_type == OR) {
@@ -80,19 +90,20 @@ std::any Interpreter::visitLogicalExpr(expr::Logical* expr)
     return evaluate(expr->m_right);
 }
 
-std::any Interpreter::visitGroupingExpr(expr::Grouping* expr)
+Value Interpreter::visitGroupingExpr(expr::Grouping* expr)
 {
     return evaluate(expr->m_expression);
 }
 
-std::any Interpreter::visitUnaryExpr(expr::Unary* expr)
+Value Interpreter::visitUnaryExpr(expr::Unary* expr)
 {
     auto right = evaluate(expr->m_right);
     switch (expr->m_op.m_type) {
     case BANG:
         return !isTruthy(right);
     case MINUS:
-        return -std::any_cast<double>(right);
+        checkNumberOperand(expr->m_op, right);
+        return -right.asNumber();
     default:
         break;
     }
@@ -100,7 +111,7 @@ std::any Interpreter::visitUnaryExpr(expr::Unary* expr)
     return nullptr;
 }
 
-std::any Interpreter::visitBinaryExpr(expr::Binary* expr)
+Value Interpreter::visitBinaryExpr(expr::Binary* expr)
 {
     auto left = evaluate(expr->m_left);
     auto right = evaluate(expr->m_right);
@@ -108,44 +119,42 @@ std::any Interpreter::visitBinaryExpr(expr::Binary* expr)
     switch (expr->m_op.m_type) {
     case GREATER:
         checkNumberOperands(expr->m_op, left, right);
-        return std::any_cast<double>(left) > std::any_cast<double>(right);
+        return left.asNumber() > right.asNumber();
     case GREATER_EQUAL:
         checkNumberOperands(expr->m_op, left, right);
-        return std::any_cast<double>(left) >= std::any_cast<double>(right);
+        return left.asNumber() >= right.asNumber();
     case LESS:
         checkNumberOperands(expr->m_op, left, right);
-        return std::any_cast<double>(left) < std::any_cast<double>(right);
+        return left.asNumber() < right.asNumber();
     case LESS_EQUAL:
         checkNumberOperands(expr->m_op, left, right);
-        return std::any_cast<double>(left) <= std::any_cast<double>(right);
+        return left.asNumber() <= right.asNumber();
     case MINUS:
         checkNumberOperands(expr->m_op, left, right);
-        return std::any_cast<double>(left) - std::any_cast<double>(right);
+        return left.asNumber() - right.asNumber();
     case SLASH:
     {
         checkNumberOperands(expr->m_op, left, right);
-        auto rightVal = std::any_cast<double>(right);
+        auto rightVal = right.asNumber();
         if (rightVal == 0) {
-            throw NexRunTimeError(expr->m_op, L"Division by zero");
+            throw NexRunTimeError(expr->m_op, "Division by zero");
         }
-        return std::any_cast<double>(left) / std::any_cast<double>(right);
+        return left.asNumber() / rightVal;
     }
     case STAR:
         checkNumberOperands(expr->m_op, left, right);
-        return std::any_cast<double>(left) * std::any_cast<double>(right);
+        return left.asNumber() * right.asNumber();
     case PLUS:
     {
-        if (auto pLeft = std::any_cast<double>(&left))
-        if (auto pRight = std::any_cast<double>(&right)) {
-            return *pLeft + *pRight;
+        if (left.isNumber() && right.isNumber()) {
+            return left.asNumber() + right.asNumber();
         }
 
-        if (auto pLeft = std::any_cast<std::wstring>(&left))
-        if (auto pRight = std::any_cast<std::wstring>(&right)) {
-            return *pLeft + *pRight;
+        if (left.isString() && right.isString()) {
+            return NexString::concat(left.asString(), right.asString());
         }
 
-        throw NexRunTimeError(expr->m_op, L"Operans must be two numbers or two strings");
+        throw NexRunTimeError(expr->m_op, "Operans must be two numbers or two strings");
     }
     case BANG_EQUAL: return !isEqual(left, right);
     case EQUAL_EQUAL: return isEqual(left, right);
@@ -156,77 +165,111 @@ std::any Interpreter::visitBinaryExpr(expr::Binary* expr)
     return nullptr;
 }
 
-std::any Interpreter::visitCallExpr(expr::Call* expr)
-{
-    std::any calle = evaluate(expr->m_callee);
-    std::vector<std::any> arguments;
-    for (auto arg : expr->m_arguments) {
-        arguments.push_back(evaluate(arg));
+Value Interpreter::visitCallExpr(expr::Call* expr)
+{
+    // obj.method(...) calls the method straight from the call site's cache
+    // instead of materializing a bound function first
+    if (auto pGet = dynamic_cast<expr::Get*>(expr->m_callee)) {
+        auto object = evaluate(pGet->m_object);
+        if (object.isInstance()) {
+            auto instance = object.asInstance();
+            auto slot = instance->lookup(pGet->m_name, expr->m_cache);
+            if (slot.kind == PropertySlot::METHOD) {
+                auto method = static_cast<NexFunction*>(slot.pMethod);
+                auto arguments = evaluateArguments(expr);
+                checkArity(expr->m_paren, method, arguments.size());
+                auto result = method->callMethod(this, instance, arguments);
+                releaseArguments(arguments);
+                return result;
+            }
+            return call(expr, instance->get(pGet->m_name, expr->m_cache));
+        }
+        return call(expr, visitGetExpr(pGet, object));
     }
 
-    if (std::any_cast<std::shared_ptr<NexCallable>>(&calle) == nullptr) {
-        throw NexRunTimeError(expr->m_paren, L"Can only call functions and classes");
+    return call(expr, evaluate(expr->m_callee));
+}
+
+Value Interpreter::call(expr::Call* expr, const Value& calle)
+{
+    auto arguments = evaluateArguments(expr);
+
+    if (!calle.isCallable()) {
+        throw NexRunTimeError(expr->m_paren, "Can only call functions and classes");
     }
 
-    auto callable = std::any_cast<std::shared_ptr<NexCallable>>(calle);
+    auto callable = calle.asCallable();
+    checkArity(expr->m_paren, callable, arguments.size());
+
+    try {
+        auto result = callable->call(this, arguments);
+        releaseArguments(arguments);
+        return result;
+    } catch (const NativeError& e) {
+        throw NexRunTimeError(expr->m_paren, e.msg());
+    }
+}
 
-    if (arguments.size() != callable->arity()) {
-        throw NexRunTimeError(expr->m_paren,
-            L"'" + callable->name() +
-            L"' expected " + std::to_wstring(callable->arity()) +
-            L" arguments but got " +
-            std::to_wstring(arguments.size()) + L".");
+void Interpreter::checkArity(const SlimToken& paren, NexCallable* callable, size_t argc)
+{
+    if (argc != callable->arity()) {
+        throw NexRunTimeError(paren,
+            "'" + callable->name() +
+            "' expected " + std::to_string(callable->arity()) +
+            " arguments but got " +
+            std::to_string(argc) + ".");
     }
+}
 
-    return callable->call(this, arguments);
+Value Interpreter::visitGetExpr(expr::Get* expr)
+{
+    return visitGetExpr(expr, evaluate(expr->m_object));
 }
 
-std::any Interpreter::visitGetExpr(expr::Get* expr)
+Value Interpreter::visitGetExpr(expr::Get* expr, const Value& object)
 {
-    auto object = evaluate(expr->m_object);
-    if (auto pObject = std::any_cast<std::shared_ptr<NexInstance>>(&object)) {
-        return (*pObject)->get(expr->m_name);
+    if (object.isInstance()) {
+        return object.asInstance()->get(expr->m_name, expr->m_cache);
     }
 
     throw NexRunTimeError(expr->m_name,
-        L"Object has not property '" + expr->m_name.m_lexeme + L"'");
+        "Object has not property '" + expr->m_name.lexeme() + "'");
 }
 
-std::any Interpreter::visitSetExpr(expr::Set* expr)
+Value Interpreter::visitSetExpr(expr::Set* expr)
 {
     auto object = evaluate(expr->m_object);
 
-    if (auto pInstance = std::any_cast<std::shared_ptr<NexInstance>>(&object)) {
+    if (object.isInstance()) {
         auto value = evaluate(expr->m_value);
-        (*pInstance)->set(expr->m_name, value);
+        object.asInstance()->set(expr->m_name, value, expr->m_cache);
         return value;
     }
 
     throw NexRunTimeError(expr->m_name,
-        L"Object has not property '" + expr->m_name.m_lexeme + L"'");
+        "Object has not property '" + expr->m_name.lexeme() + "'");
 }
 
-std::any Interpreter::visitSuperExpr(expr::Super* expr)
+Value Interpreter::visitSuperExpr(expr::Super* expr)
 {
-    auto distance = m_locals[expr];
-    auto superclass = std::any_cast<std::shared_ptr<NexClass>>(m_pEnv->getAt(distance, L"super"));
-    auto object = std::any_cast<std::shared_ptr<NexInstance>>(m_pEnv->getAt(distance - 1, L"this"));
+    auto superclass = lookUpVariable(expr->m_keyword, expr->m_resolution);
+    auto object = lookUpVariable(expr->m_keyword, expr->m_thisResolution);
 
-    auto method = superclass->findMethod(expr->m_method.m_lexeme);
+    auto method = superclass.asClass()->findMethod(expr->m_method.m_symbol);
 
     if (!method) {
-        throw NexRunTimeError(expr->m_method, L"Undefined property '" + expr->m_method.m_lexeme + L"'.");
+        throw NexRunTimeError(expr->m_method, "Undefined property '" + expr->m_method.lexeme() + "'.");
     }
 
-    return std::dynamic_pointer_cast<NexCallable>(method->bind(object));
+    return method->bind(object.asInstance());
 }
 
-std::any Interpreter::visitThisExpr(expr::This* expr)
+Value Interpreter::visitThisExpr(expr::This* expr)
 {
-    return lookUpVariable(expr->m_keyword, expr);
+    return lookUpVariable(expr->m_keyword, expr->m_resolution);
 }
 
-std::any Interpreter::visitCommaExpr(expr::Comma* expr)
+Value Interpreter::visitCommaExpr(expr::Comma* expr)
 {
     for (auto e : expr->m_exprs) {
         evaluate(e);
@@ -234,20 +277,20 @@ std::any Interpreter::visitCommaExpr(expr::Comma* expr)
     return evaluate(expr->m_last);
 }
 
-std::any Interpreter::visitVariableExpr(expr::Variable* expr)
+Value Interpreter::visitVariableExpr(expr::Variable* expr)
 {
-    return lookUpVariable(expr->m_name, expr);
+    return lookUpVariable(expr->m_name, expr->m_resolution);
 }
 
-std::any Interpreter::visitInputExpr(expr::Input* expr)
+Value Interpreter::visitInputExpr(expr::Input* expr)
 {
     (void) expr;
-    std::wstring in;
-    std::wcin >> in;
+    std::string in;
+    std::cin >> in;
     return in;
 }
 
-std::any Interpreter::visitIfStmt(stmt::If* stmt)
+void Interpreter::visitIfStmt(stmt::If* stmt)
 {
     if (isTruthy(evaluate(stmt->m_cond))) {
         execute(stmt->m_thenBranch);
@@ -255,254 +298,338 @@ std::any Interpreter::visitIfStmt(stmt::If* stmt)
     else if (stmt->m_elseBranch != nullptr) {
         execute(stmt->m_elseBranch);
     }
-
-    return nullptr;
 }
 
-std::any Interpreter::visitBlockStmt(stmt::Block* stmt)
+void Interpreter::visitBlockStmt(stmt::Block* stmt)
 {
-    auto newEnv = std::make_shared<Environment>(L"block");
-    newEnv->m_pEnclosing = m_pEnv;
-
-    executeBlock(stmt->m_statements, newEnv);
-    return nullptr;
+    // Locals of the block are slots of the current frame
+    executeStatements(stmt->m_statements);
 }
 
-std::any Interpreter::visitClassStmt(stmt::Class* stmt)
+void Interpreter::visitClassStmt(stmt::Class* stmt)
 {
-    std::shared_ptr<NexClass> superclass = nullptr;
+    Ref<NexClass> superclass = nullptr;
     if (stmt->m_superclass) {
-        std::any evalSuper = evaluate(stmt->m_superclass);
-        auto ppCallable = std::any_cast<std::shared_ptr<NexCallable>>(&evalSuper);
+        Value evalSuper = evaluate(stmt->m_superclass);
 
-        if (ppCallable) {
-            superclass = std::dynamic_pointer_cast<NexClass>(*ppCallable);
+        if (!evalSuper.isClass()) {
+            throw NexRunTimeError(stmt->m_superclass->m_name, "Superclass must be a class.");
         }
 
-        if (!ppCallable || !superclass) {
-            throw NexRunTimeError(stmt->m_superclass->m_name, L"Superclass must be a class.");
-        }
+        superclass = evalSuper.asClass();
     }
 
-    m_pEnv->define(stmt->m_name, nullptr);
+    // Methods that refer to the class capture its variable, it must exist
+    // before they do
+    define(stmt->m_name, stmt->m_resolution, nullptr);
 
     if (stmt->m_superclass) {
-        auto superEnv = std::make_shared<Environment>(L"super");
-        superEnv->copy(m_pEnv);
-        m_pEnv = superEnv;
-
-        Token super(SUPER, L"super", nullptr, 0);
-        superEnv->define(super, superclass);
+        define(stmt->m_name, stmt->m_superResolution, superclass);
     }
 
-    NexClass::Fields fields;
-    for (auto field : stmt->m_fields) {
-        fields[field->m_name.m_lexeme] = field;
-    }
+    NexClass::Fields fields(stmt->m_fields.begin(), stmt->m_fields.end());
 
     NexClass::Methods methods;
     for (auto  method : stmt->m_methods) {
-        auto bIsInitializer = method->m_name.m_lexeme == L"init";
+        auto bIsInitializer = method->m_name.lexeme() == "init";
 
-        methods[method->m_name.m_lexeme] =
-            std::make_shared<NexFunction>(*method, m_pEnv, bIsInitializer);
+        methods[method->m_name.m_symbol] =
+            Heap::make<NexFunction>(*method, capture(method->m_captures), bIsInitializer);
     }
 
-    auto klass = std::dynamic_pointer_cast<NexCallable>(
-        std::make_shared<NexClass>(stmt->m_name.m_lexeme, superclass, fields, methods));
+    auto klass = Heap::make<NexClass>(stmt->m_name.lexeme(), superclass, fields, methods,
+                                      capture(stmt->m_fieldCaptures));
 
-    if (superclass) {
-        m_pEnv = m_pEnv->m_pEnclosing;
+    assign(stmt->m_name, stmt->m_resolution, klass);
+}
+
+Value Interpreter::executeFunction(NexFunction* function,
+                                   NexInstance* receiver,
+                                   Arguments arguments)
+{
+    // The arguments are the first slots of the frame, a method's receiver
+    // goes in the slot left before them
+    const auto& declaration = function->declaration();
+    auto previous = m_frame;
+    m_frame.pSlots = arguments.data();
+    if (receiver) {
+        *--m_frame.pSlots = receiver;
     }
+    m_frame.pTop = arguments.end();
+    m_frame.pUpvalues = &function->upvalues();
 
-    m_pEnv->assign(stmt->m_name, klass);
+    // Captured parameters move to their cell before the body runs
+    for (auto slot : declaration.m_cells) {
+        auto& value = m_frame.pSlots[slot];
+        value = Heap::make<Cell>(std::move(value));
+    }
 
-    return nullptr;
+    Value result = nullptr;
+    m_callDepth++;
+    if (executeStatements(declaration.m_body) == Completion::RETURN) {
+        result = takeReturnValue();
+    }
+    m_callDepth--;
+
+    popFrame(previous);
+
+    if (function->isInitializer()) {
+        return receiver;
+    }
+
+    return result;
 }
 
-void  Interpreter::executeBlock(std::vector<std::shared_ptr<stmt::Stmt>> statements,
-                                std::shared_ptr<Environment> pEnv)
+void Interpreter::initializeFields(NexClass* klass, NexInstance* instance)
 {
-    auto previous = m_pEnv;
-    try {
-        m_pEnv = pEnv;
-        for (auto stmt : statements) {
-            execute(stmt);
+    if (klass->m_fields.empty()) {
+        return;
+    }
+
+    // The instance is the only slot of the frame
+    if (m_frame.pTop == m_stack.data() + m_stack.size()) {
+        throw NexRunTimeError(klass->m_fields.front()->m_name, "Stack overflow.");
+    }
+    auto previous = m_frame;
+    m_frame.pSlots = m_frame.pTop;
+    *m_frame.pTop++ = instance;
+    m_frame.pUpvalues = &klass->m_fieldCells;
+
+    m_callDepth++;
+    for (size_t idx = 0; idx < klass->m_fields.size(); idx++) {
+        if (auto init = klass->m_fields[idx]->m_init) {
+            instance->field(idx) = evaluate(init);
         }
-    } catch (const NexReturn& e) {
-        m_pEnv = previous;
-        throw e;
-    } catch (const NexRunTimeError& e) {
-        m_pEnv = previous;
-        throw e;
-    } catch (...) {
-        std::cout << "INTERPRETER ERROR: unhandled exception" << std::endl;
     }
+    m_callDepth--;
+
+    popFrame(previous);
+}
 
-    m_pEnv = previous;
+Interpreter::Completion
+Interpreter::executeStatements(ArenaList<stmt::Stmt*> statements)
+{
+    for (const auto& stmt : statements) {
+        execute(stmt);
+        if (m_completion != Completion::NORMAL) {
+            break;
+        }
+    }
+    return m_completion;
 }
 
-std::any Interpreter::visitExpressionStmt(stmt::Expression* stmt)
+Value Interpreter::takeReturnValue()
+{
+    m_completion = Completion::NORMAL;
+    return std::move(m_returnValue);
+}
+
+void Interpreter::visitExpressionStmt(stmt::Expression* stmt)
 {
     evaluate(stmt->m_e);
-    return nullptr;
 }
 
-std::any Interpreter::visitFunctionStmt(stmt::Function* stmt)
+void Interpreter::visitFunctionStmt(stmt::Function* stmt)
 {
-    std::shared_ptr<NexCallable> func =
-        std::make_shared<NexFunction>(*stmt, m_pEnv, false);
-    m_pEnv->define(stmt->m_name, func);
-    return nullptr;
+    // A function calling itself captures its own variable, it must exist
+    // before the function does
+    define(stmt->m_name, stmt->m_resolution, nullptr);
+    assign(stmt->m_name, stmt->m_resolution,
+           Heap::make<NexFunction>(*stmt, capture(stmt->m_captures), false));
 }
 
-std::any Interpreter::visitPrintStmt(stmt::Print* stmt)
+void Interpreter::visitPrintStmt(stmt::Print* stmt)
 {
     auto value = evaluate(stmt->m_e);
-    std::wcout << stringify(value) << std::endl;
-    return nullptr;
+    std::cout << stringify(value) << std::endl;
 }
 
-std::any Interpreter::visitLetStmt(stmt::Let* stmt)
+void Interpreter::visitLetStmt(stmt::Let* stmt)
 {
-    std::any value = nullptr;
+    Value value = nullptr;
     if (stmt->m_init != nullptr) {
         value = evaluate(stmt->m_init);
     }
 
-    m_pEnv->define(stmt->m_name, value);
-    return nullptr;
+    define(stmt->m_name, stmt->m_resolution, std::move(value));
 }
 
-std::any Interpreter::visitWhileStmt(stmt::While* stmt)
+void Interpreter::visitWhileStmt(stmt::While* stmt)
 {
     while (isTruthy(evaluate(stmt->m_cond))) {
         execute(stmt->m_body);
+        if (m_completion != Completion::NORMAL) {
+            break;
+        }
     }
-    return nullptr;
 }
 
-std::any Interpreter::visitReturnStmt(stmt::Return* stmt)
+void Interpreter::visitReturnStmt(stmt::Return* stmt)
 {
-    std::any value = nullptr;
+    Value value = nullptr;
     if (stmt->m_value != nullptr) {
         value = evaluate(stmt->m_value);
     }
 
-    throw NexReturn(value);
+    m_returnValue = std::move(value);
+    m_completion = Completion::RETURN;
 }
 
-bool Interpreter::isEqual(std::any right, std::any left)
+bool Interpreter::isEqual(const Value& right, const Value& left)
 {
-    if (auto pLeft = std::any_cast<std::nullptr_t>(&left))
-    if (auto pRight = std::any_cast<std::nullptr_t>(&right)) {
-        return true;
-    }
-
-    if (auto pLeft = std::any_cast<std::nullptr_t>(&left)) {
-        return false;
-    }
-
-    if (auto pLeft = std::any_cast<double>(&left))
-    if (auto pRight = std::any_cast<double>(&right)) {
-        return *pLeft == *pRight;
-    }
-
-    if (auto pLeft = std::any_cast<std::wstring>(&left))
-    if (auto pRight = std::any_cast<std::wstring>(&right)) {
-        return *pLeft == *pRight;
-    }
-
-    return false;
+    return left == right;
 }
 
-std::any Interpreter::evaluate(std::shared_ptr<expr::Expr> e)
+Value Interpreter::evaluate(expr::Expr* e)
 {
     return e->accept(this);
 }
 
-bool Interpreter::isTruthy(std::any value)
+bool Interpreter::isTruthy(const Value& value)
 {
-    if (std::any_cast<std::nullptr_t>(&value)) {
-        return false;
-    }
+    return value.isTruthy();
+}
 
-    if (auto pVal = std::any_cast<bool>(&value)) {
-        return *pVal;
+void Interpreter::checkNumberOperand(const SlimToken& op, const Value& operand)
+{
+    if (operand.isNumber()) {
+        return;
     }
 
-    return true;
+    throw NexRunTimeError(op, "Operand must be a number");
 }
 
-void Interpreter::checkNumberOperand(const Token& op, const std::any& operand)
+void Interpreter::checkNumberOperands(const SlimToken& op,
+                                      const Value& left,
+                                      const Value& right)
 {
-    if (auto pOperand = std::any_cast<double>(&operand)) {
+    if (left.isNumber() && right.isNumber()) {
         return;
     }
 
-    throw NexRunTimeError(op, L"Operand must be a number");
+    throw NexRunTimeError(op, "Operands muse be numbers.");
 }
 
-void Interpreter::checkNumberOperands(const Token& op,
-                                      const std::any& left,
-                                      const std::any& right)
+std::string Interpreter::stringify(const Value& value)
 {
-    if (auto pLeft = std::any_cast<double>(&left))
-    if (auto pRight = std::any_cast<double>(&right)) {
-        return;
-    }
+    return value.toString();
+}
 
-    throw NexRunTimeError(op, L"Operands muse be numbers.");
+Value Interpreter::lookUpVariable(SlimToken const& name, const Resolution& resolution)
+{
+    switch (resolution.kind) {
+    case Resolution::LOCAL:
+        return m_frame.pSlots[resolution.slot];
+    case Resolution::CELL:
+        return m_frame.pSlots[resolution.slot].as<Cell>()->m_value;
+    case Resolution::UPVALUE:
+        return (*m_frame.pUpvalues)[resolution.slot]->m_value;
+    default:
+        return m_globals.get(name, resolution.slot);
+    }
 }
 
-std::wstring Interpreter::stringify(const std::any& value)
+void Interpreter::define(const SlimToken& name, const Resolution& resolution, Value value)
 {
-    std::wstringstream wss;
-    if (auto num = std::any_cast<double>(&value)) {
-        wss << *num;
+    switch (resolution.kind) {
+    case Resolution::LOCAL:
+        declareSlot(name, resolution.slot) = std::move(value);
+        break;
+    case Resolution::CELL:
+        declareSlot(name, resolution.slot) = Heap::make<Cell>(std::move(value));
+        break;
+    default:
+        m_globals.define(name, std::move(value));
+        break;
     }
-    else if (auto str = std::any_cast<std::wstring>(&value)) {
-        wss << *str;
-    
+}
+
+void Interpreter::assign(const SlimToken& name, const Resolution& resolution, Value value)
+{
+    switch (resolution.kind) {
+    case Resolution::LOCAL:
+        m_frame.pSlots[resolution.slot] = std::move(value);
+        break;
+    case Resolution::CELL:
+        m_frame.pSlots[resolution.slot].as<Cell>()->m_value = std::move(value);
+        break;
+    case Resolution::UPVALUE:
+        (*m_frame.pUpvalues)[resolution.slot]->m_value = std::move(value);
+        break;
+    default:
+        m_globals.assign(name, resolution.slot, std::move(value));
+        break;
     }
-    else if (auto pBoolean = std::any_cast<bool>(&value)) {
-        if (*pBoolean) {
-            wss << "true";
+}
+
+HeapVector<Ref<Cell>> Interpreter::capture(ArenaList<Capture> captures)
+{
+    HeapVector<Ref<Cell>> cells;
+    cells.reserve(captures.size());
+    for (const auto& capture : captures) {
+        if (capture.bLocal) {
+            cells.emplace_back(m_frame.pSlots[capture.index].as<Cell>());
         }
         else {
-            wss << "false";
+            cells.push_back((*m_frame.pUpvalues)[capture.index]);
         }
     }
-    else if (auto callable = std::any_cast<std::shared_ptr<NexCallable>>(&value)) {
-        wss << (*callable)->to_string();
-    }
-    else if (auto klass = std::any_cast<std::shared_ptr<NexClass>>(&value)) {
-        wss << (*klass)->to_string();
-    }
-    else if (auto instance = std::any_cast<std::shared_ptr<NexInstance>>(&value)) {
-        wss << (*instance)->to_string();
+    return cells;
+}
+
+Arguments Interpreter::evaluateArguments(expr::Call* expr)
+{
+    auto pBase = m_frame.pTop;
+    auto argc = expr->m_arguments.size();
+    if (m_callDepth >= MAX_CALL_DEPTH ||
+        pBase + argc + 1 > m_stack.data() + m_stack.size()) {
+        throw NexRunTimeError(expr->m_paren, "Stack overflow.");
     }
-    else {
-        wss << "nil";
+
+    // Each argument is part of the frame once evaluated, calls made by the
+    // next ones start after it
+    m_frame.pTop = pBase + 1;
+    for (auto arg : expr->m_arguments) {
+        auto value = evaluate(arg);
+        *m_frame.pTop++ = std::move(value);
     }
-    return wss.str();
+
+    return Arguments(pBase + 1, argc);
 }
 
-void Interpreter::resolve(expr::Expr* expr, size_t idx)
+void Interpreter::releaseArguments(Arguments arguments)
 {
-    m_locals[expr] = idx;
+    auto pBase = arguments.data() - 1;
+    for (auto pSlot = pBase; pSlot != m_frame.pTop; pSlot++) {
+        if (pSlot->isObject()) {
+            *pSlot = nullptr;
+        }
+    }
+    m_frame.pTop = pBase;
 }
 
-std::any Interpreter::lookUpVariable(Token const& name, expr::Expr* expr)
+void Interpreter::popFrame(const Frame& previous)
 {
-    if (m_locals.count(expr)) {
-        auto distance = m_locals[expr];
-        return m_pEnv->getAt(distance, name.m_lexeme);
-    }
-    else {
-        return m_pEnv->get(name);
+    // Slots are only read after a declaration wrote them, only the
+    // references they hold need to go
+    for (auto pSlot = m_frame.pSlots; pSlot != m_frame.pTop; pSlot++) {
+        if (pSlot->isObject()) {
+            *pSlot = nullptr;
+        }
     }
+    m_frame = previous;
 }
 
+Value& Interpreter::declareSlot(const SlimToken& name, uint32_t slot)
+{
+    auto pSlot = m_frame.pSlots + slot;
+    if (pSlot >= m_frame.pTop) {
+        if (pSlot >= m_stack.data() + m_stack.size()) {
+            throw NexRunTimeError(name, "Stack overflow.");
+        }
+        m_frame.pTop = pSlot + 1;
+    }
+    return *pSlot;
 }
 
+}
@@ -3,15 +3,21 @@
 
 #include "nex_expr.hpp"
 #include "nex_stmt.hpp"
-#include "nex_environment.hpp"
+#include "nex_callable.hpp"
+#include "nex_cell.hpp"
+#include "nex_globals.hpp"
+#include "nex_native.hpp"
+#include "nex_value.hpp"
 #include <iostream>
-#include <locale>
-#include <codecvt>
 
 namespace nex {
 
 using namespace nex::ast;
 
+class NexClass;
+class NexFunction;
+class NexInstance;
+
 class Interpreter final : public expr::Visitor, public stmt::Visitor
 {
 public:
@@ -19,67 +25,122 @@ public:
 
     ~Interpreter() = default;
 
-    void interpret(std::vector<std::shared_ptr<stmt::Stmt>> stmts);
+    void interpret(ArenaList<stmt::Stmt*> stmts);
 
     inline bool error() const { return m_bHadRuntimeError; }
 
-    std::any visitAssignExpr(expr::Assign* expr) override;
-    std::any visitBinaryExpr(expr::Binary* expr) override;
-    std::any visitCallExpr(expr::Call* expr) override;
-    std::any visitGetExpr(expr::Get* expr) override;
-    std::any visitSetExpr(expr::Set* expr) override;
-    std::any visitSuperExpr(expr::Super* expr) override;
-    std::any visitThisExpr(expr::This* expr) override;
-    std::any visitGroupingExpr(expr::Grouping* expr) override;
-    std::any visitLiteralExpr(expr::Literal* expr) override;
-    std::any visitLogicalExpr(expr::Logical* expr) override;
-    std::any visitUnaryExpr(expr::Unary* expr) override;
-    std::any visitCommaExpr(expr::Comma* expr) override;
-    std::any visitVariableExpr(expr::Variable* expr) override;
-    std::any visitInputExpr(expr::Input* stmt) override;
-
-    std::any visitBlockStmt(stmt::Block* stmt) override;
-    std::any visitClassStmt(stmt::Class* stmt) override;
-    std::any visitFunctionStmt(stmt::Function* stmt) override;
-    std::any visitIfStmt(stmt::If* stmt) override;
-    std::any visitExpressionStmt(stmt::Expression* stmt) override;
-    std::any visitPrintStmt(stmt::Print* stmt) override;
-    std::any visitLetStmt(stmt::Let* stmt) override;
-    std::any visitWhileStmt(stmt::While* stmt) override;
-    std::any visitReturnStmt(stmt::Return* stmt) override;
-
-    inline std::shared_ptr<Environment> getGlobalEnv() const
-    {
-        return m_pGlobals;
-    }
+    // Defines 'function' as a global, a script may declare its name once
+    // more to replace it
+    void defineNative(Ref<NativeFunction> function);
 
-    inline std::shared_ptr<Environment> getEnv() const
+    // Wraps and defines the C++ function 'F', see makeNative
+    template <auto F>
+    inline void defineNative(const char* name)
     {
-        return m_pEnv;
+        defineNative(makeNative<F>(name));
     }
 
-    void execute(std::shared_ptr<stmt::Stmt> s);
-    void executeBlock(std::vector<std::shared_ptr<stmt::Stmt>> statements,
-                      std::shared_ptr<Environment> env);
-
-    void resolve(expr::Expr* expr, size_t idx);
+    Value visitAssignExpr(expr::Assign* expr) override;
+    Value visitBinaryExpr(expr::Binary* expr) override;
+    Value visitCallExpr(expr::Call* expr) override;
+    Value visitGetExpr(expr::Get* expr) override;
+    Value visitSetExpr(expr::Set* expr) override;
+    Value visitSuperExpr(expr::Super* expr) override;
+    Value visitThisExpr(expr::This* expr) override;
+    Value visitGroupingExpr(expr::Grouping* expr) override;
+    Value visitLiteralExpr(expr::Literal* expr) override;
+    Value visitLogicalExpr(expr::Logical* expr) override;
+    Value visitUnaryExpr(expr::Unary* expr) override;
+    Value visitCommaExpr(expr::Comma* expr) override;
+    Value visitVariableExpr(expr::Variable* expr) override;
+    Value visitInputExpr(expr::Input* stmt) override;
+
+    void visitBlockStmt(stmt::Block* stmt) override;
+    void visitClassStmt(stmt::Class* stmt) override;
+    void visitFunctionStmt(stmt::Function* stmt) override;
+    void visitIfStmt(stmt::If* stmt) override;
+    void visitExpressionStmt(stmt::Expression* stmt) override;
+    void visitPrintStmt(stmt::Print* stmt) override;
+    void visitLetStmt(stmt::Let* stmt) override;
+    void visitWhileStmt(stmt::While* stmt) override;
+    void visitReturnStmt(stmt::Return* stmt) override;
+
+    // How the last statement finished. A 'ret' leaves RETURN behind and the
+    // enclosing blocks and loops stop until the function call consumes it
+    // with takeReturnValue().
+    enum class Completion {
+        NORMAL,
+        RETURN,
+    };
+
+    void execute(stmt::Stmt* s);
+
+    // Calls 'function' in a new frame that starts on 'arguments', 'receiver'
+    // is 'this' for methods
+    Value executeFunction(NexFunction* function,
+                          NexInstance* receiver,
+                          Arguments arguments);
+
+    // Evaluates the field initializers of 'klass' into 'instance'
+    void initializeFields(NexClass* klass, NexInstance* instance);
+
+    Value takeReturnValue();
+
+    Value evaluate(expr::Expr* e);
 
 private:
-    std::any evaluate(std::shared_ptr<expr::Expr> e);
-    bool isTruthy(std::any e);
-    bool isEqual(std::any right, std::any left);
-    std::wstring stringify(const std::any& value);
-    void checkNumberOperand(const Token& op, const std::any& operand);
-    void checkNumberOperands(const Token& op,
-                             const std::any& left,
-                             const std::any& right);
-    std::any lookUpVariable(Token const& name, expr::Expr* expr);
+    bool isTruthy(const Value& value);
+    bool isEqual(const Value& right, const Value& left);
+    std::string stringify(const Value& value);
+    void checkNumberOperand(const SlimToken& op, const Value& operand);
+    void checkNumberOperands(const SlimToken& op,
+                             const Value& left,
+                             const Value& right);
+    // Runs 'statements' in the current frame
+    Completion executeStatements(ArenaList<stmt::Stmt*> statements);
+    Value lookUpVariable(SlimToken const& name, const Resolution& resolution);
+    // Stores the variable 'name' declares where 'resolution' says, a new Cell
+    // when it is captured
+    void define(const SlimToken& name, const Resolution& resolution, Value value);
+    void assign(const SlimToken& name, const Resolution& resolution, Value value);
+    // The cells a function declared now captures
+    HeapVector<Ref<Cell>> capture(ArenaList<Capture> captures);
+    Value visitGetExpr(expr::Get* expr, const Value& object);
+    Value call(expr::Call* expr, const Value& calle);
+    void checkArity(const SlimToken& paren, NexCallable* callable, size_t argc);
+
+    // The slots of a call, on m_stack
+    struct Frame {
+        // First slot, locals are addressed from it
+        Value* pSlots;
+        // Past the last slot in use, the next frame starts there
+        Value* pTop;
+        // Cells captured by the running function
+        const HeapVector<Ref<Cell>>* pUpvalues;
+    };
+
+    // Evaluates the arguments of 'expr' on top of the current frame, after
+    // a slot left for the receiver
+    Arguments evaluateArguments(expr::Call* expr);
+    // Pops the arguments once the call returned
+    void releaseArguments(Arguments arguments);
+    // Releases the slots of the current frame and returns to 'previous'
+    void popFrame(const Frame& previous);
+    // The slot a declaration writes to, the frame grows to include it
+    Value& declareSlot(const SlimToken& name, uint32_t slot);
 
 private:
+    static constexpr size_t STACK_MAX = 64 * 1024;
+
     bool m_bHadRuntimeError;
-    std::shared_ptr<Environment> m_pEnv;
-    std::shared_ptr<Environment> m_pGlobals;
-    std::map<expr::Expr*, int> m_locals;
+    std::vector<Value> m_stack;
+    Frame m_frame;
+    // Function bodies and field initializers running, a call past
+    // MAX_CALL_DEPTH of them is a stack overflow
+    size_t m_callDepth;
+    GlobalTable m_globals;
+    Completion m_completion;
+    Value m_returnValue;
 };
 
 
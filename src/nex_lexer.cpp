@@ -1,79 +1,276 @@
 #include "nex_lexer.hpp"
 #include "nex_diag.hpp"
+#include "nex_symbol.hpp"
 
-#include <iterator>
-#include <cctype>
+#include <array>
+#include <charconv>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace nex {
 
 namespace {
-const std::map<std::wstring, TokenType> g_keywords {
+
+constexpr uint8_t byte(char c)
+{
+    return static_cast<uint8_t>(c);
+}
+
+// Classes of the bytes the lexer dispatches on, bytes above 0x7f (UTF-8
+// sequences) are in none
+enum CharClass : uint8_t {
+    CHAR_ALPHA = 1 << 0,
+    CHAR_DIGIT = 1 << 1,
+    CHAR_SPACE = 1 << 2,
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses()
+{
+    std::array<uint8_t, 256> classes{};
+    for (int c = 'a'; c <= 'z'; c++) {
+        classes[c] |= CHAR_ALPHA;
+    }
+    for (int c = 'A'; c <= 'Z'; c++) {
+        classes[c] |= CHAR_ALPHA;
+    }
+    classes['_'] |= CHAR_ALPHA;
+    for (int c = '0'; c <= '9'; c++) {
+        classes[c] |= CHAR_DIGIT;
+    }
+    classes[' '] |= CHAR_SPACE;
+    classes['\t'] |= CHAR_SPACE;
+    classes['\r'] |= CHAR_SPACE;
+    classes['\n'] |= CHAR_SPACE;
+    return classes;
+}
+
+constexpr auto g_charClasses = makeCharClasses();
+
+// Tokens made of one byte that never starts a longer token, TOKEN_NUM for
+// every other byte. A '/' is always a SLASH here, comments are skipped
+// before a token starts.
+constexpr std::array<TokenType, 256> makeSingleTokens()
+{
+    std::array<TokenType, 256> tokens{};
+    for (auto& token : tokens) {
+        token = TOKEN_NUM;
+    }
+    tokens['('] = LEFT_PAREN;
+    tokens[')'] = RIGHT_PAREN;
+    tokens['{'] = LEFT_BRACE;
+    tokens['}'] = RIGHT_BRACE;
+    tokens[','] = COMMA;
+    tokens['.'] = DOT;
+    tokens['+'] = PLUS;
+    tokens[':'] = COLON;
+    tokens[';'] = SEMICOLON;
+    tokens['*'] = STAR;
+    tokens['/'] = SLASH;
+    tokens['?'] = QUESTION_MARK;
+    return tokens;
+}
+
+constexpr auto g_singleTokens = makeSingleTokens();
+
+struct Keyword {
+    std::string_view text;
+    TokenType type = IDENTIFIER;
+};
+
+constexpr Keyword KEYWORDS[] = {
     // Keywords
-    { L"and", AND },
-    { L"class", CLASS },
-    { L"else", ELSE },
-    { L"false", FALSE },
-    { L"for", FOR },
-    { L"func", FUNC },
-    { L"if", IF },
-    { L"nil", NIL },
-    { L"or", OR },
-    { L"print", PRINT },
-    { L"input", INPUT },
-    { L"ret", RET },
-    { L"super", SUPER },
-    { L"this", THIS },
-    { L"true", TRUE },
-    { L"const", CONST },
-    { L"let", LET },
-    { L"while", WHILE },
-    { L"typeof", TYPE_OF },
-    { L"extends", EXTENDS },
+    { "and", AND },
+    { "class", CLASS },
+    { "else", ELSE },
+    { "false", FALSE },
+    { "for", FOR },
+    { "func", FUNC },
+    { "if", IF },
+    { "nil", NIL },
+    { "or", OR },
+    { "print", PRINT },
+    { "input", INPUT },
+    { "ret", RET },
+    { "super", SUPER },
+    { "this", THIS },
+    { "true", TRUE },
+    { "const", CONST },
+    { "let", LET },
+    { "while", WHILE },
+    { "typeof", TYPE_OF },
+    { "extends", EXTENDS },
     // Built-in types
-    { L"Void", TYPE_VOID },
-    { L"Int", TYPE_INT },
-    { L"String", TYPE_STRING }
+    { "Void", TYPE_VOID },
+    { "Int", TYPE_INT },
+    { "String", TYPE_STRING },
 };
+
+constexpr size_t KEYWORD_SLOTS = 64;
+
+// Perfect hash of the keywords: no two of them share a slot, so a lexeme
+// is a keyword only if it equals the one in its slot
+constexpr size_t keywordSlot(std::string_view text)
+{
+    return (byte(text.front()) * 3 + byte(text.back()) + text.size()) & (KEYWORD_SLOTS - 1);
+}
+
+constexpr std::array<Keyword, KEYWORD_SLOTS> makeKeywordTable()
+{
+    std::array<Keyword, KEYWORD_SLOTS> table{};
+    for (const auto& keyword : KEYWORDS) {
+        table[keywordSlot(keyword.text)] = keyword;
+    }
+    return table;
+}
+
+constexpr auto g_keywordTable = makeKeywordTable();
+
+constexpr bool isPerfectHash()
+{
+    for (const auto& keyword : KEYWORDS) {
+        if (g_keywordTable[keywordSlot(keyword.text)].type != keyword.type) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isPerfectHash(), "Two keywords share a slot, change keywordSlot");
+
+inline TokenType keywordType(std::string_view text)
+{
+    const auto& keyword = g_keywordTable[keywordSlot(text)];
+    return keyword.text == text ? keyword.type : IDENTIFIER;
+}
+
+// The scans over runs of bytes compare 16 bytes at a time while that many
+// remain, and go bytewise through the rest
+
+#if defined(__SSE2__)
+constexpr ptrdiff_t BLOCK_SIZE = 16;
+
+// Bit i set where byte i of 'block' is 'c'
+inline uint32_t matches(__m128i block, char c)
+{
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))));
 }
+#endif
 
-Lexer::Lexer(std::wistream& is)
-    : m_source(std::istreambuf_iterator<wchar_t>(is), {})
-    , m_tokens()
+// First byte of [p, end) that is not whitespace, counting the newlines
+// skipped in 'lines'
+inline const char* skipSpaces(const char* p, const char* end, size_t& lines)
+{
+#if defined(__SSE2__)
+    while (end - p >= BLOCK_SIZE) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto newlines = matches(block, '\n');
+        auto spaces = newlines | matches(block, ' ') | matches(block, '\t') | matches(block, '\r');
+        if (spaces != 0xFFFF) {
+            auto offset = __builtin_ctz(~spaces);
+            lines += __builtin_popcount(newlines & ((1u << offset) - 1));
+            return p + offset;
+        }
+        lines += __builtin_popcount(newlines);
+        p += BLOCK_SIZE;
+    }
+#endif
+    while (p != end && (g_charClasses[byte(*p)] & CHAR_SPACE)) {
+        if (*p == '\n') {
+            lines++;
+        }
+        p++;
+    }
+    return p;
+}
+
+// First 'c' in [p, end), or 'end', counting the newlines before it in
+// 'lines'
+inline const char* findByte(const char* p, const char* end, char c, size_t& lines)
+{
+#if defined(__SSE2__)
+    while (end - p >= BLOCK_SIZE) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto newlines = matches(block, '\n');
+        auto found = matches(block, c);
+        if (found) {
+            auto offset = __builtin_ctz(found);
+            lines += __builtin_popcount(newlines & ((1u << offset) - 1));
+            return p + offset;
+        }
+        lines += __builtin_popcount(newlines);
+        p += BLOCK_SIZE;
+    }
+#endif
+    while (p != end && *p != c) {
+        if (*p == '\n') {
+            lines++;
+        }
+        p++;
+    }
+    return p;
+}
+
+}
+
+Lexer::Lexer(std::string_view source)
+    : m_source(source)
+    , m_token()
     , m_bHadError(false)
     , m_start(0)
     , m_current(0)
     , m_line(1)
 {}
 
-std::vector<Token> Lexer::scan()
+Token Lexer::next()
 {
-    while (!isAtEnd()) {
+    // A character that starts no token is reported and skipped
+    m_token.reset();
+    while (!m_token) {
+        skipTrivia();
+        if (isAtEnd()) {
+            return Token(END_OF_FILE, "", nullptr, m_line);
+        }
         m_start = m_current;
         scanToken();
     }
 
-    m_tokens.push_back(Token(END_OF_FILE, L"", nullptr, m_line));
-    return m_tokens;
+    return *m_token;
 }
 
 bool Lexer::isAtEnd() const {
     return m_current >= m_source.size();
 }
 
+void Lexer::skipTrivia()
+{
+    const char* begin = m_source.data();
+    const char* end = begin + m_source.size();
+    const char* p = begin + m_current;
+    while (true) {
+        p = skipSpaces(p, end, m_line);
+        if (end - p < 2 || p[0] != '/' || p[1] != '/') {
+            break;
+        }
+        // A comment runs until the end of the line
+        size_t ignored = 0;
+        p = findByte(p + 2, end, '\n', ignored);
+    }
+    m_current = p - begin;
+}
+
 void Lexer::scanToken()
 {
-    wchar_t c = advance();
+    char c = advance();
+    auto single = g_singleTokens[byte(c)];
+    if (single != TOKEN_NUM) {
+        addToken(single);
+        return;
+    }
+
     switch (c) {
-    case '(': addToken(LEFT_PAREN); break;
-    case ')': addToken(RIGHT_PAREN); break;
-    case '{': addToken(LEFT_BRACE); break;
-    case '}': addToken(RIGHT_BRACE); break;
-    case ',': addToken(COMMA); break;
-    case '.': addToken(DOT); break;
-    case '+': addToken(PLUS); break;
-    case ':': addToken(COLON); break;
-    case ';': addToken(SEMICOLON); break;
-    case '*': addToken(STAR); break;
     // Implementation notes:
     // Lexer::match could be Lexer::match(next, true val, false, val) -> val
     case '-': addToken(match('>') ? ARROW : MINUS); break;
@@ -81,45 +278,29 @@ void Lexer::scanToken()
     case '=': addToken(match('=') ? EQUAL_EQUAL : EQUAL); break;
     case '<': addToken(match('=') ? LESS_EQUAL : LESS); break;
     case '>': addToken(match('=') ? GREATER_EQUAL : GREATER); break;
-    case '?': addToken(QUESTION_MARK); break;
-    case '/':
-        if (match('/')) {
-            // It is a comment, skip until the end of the line
-            while (peek() != '\n' && !isAtEnd()) {
-                advance();
-            }
-        }
-        else {
-            addToken(SLASH);
-        }
-        break;
-    // Ignore whitespace
-    case ' ':
-    case '\r':
-    case '\t':
-        break;
-    case '\n':
-        m_line++;
-        break;
     case '"': handleString(); break;
     default:
-        if (std::isdigit(c)) {
+        if (isDigit(c)) {
             handleNumber();
         }
         else if (isAlpha(c)) {
             handleIdentifier();
         }
         else {
+            // The source is UTF-8, report the whole character and not only
+            // its lead byte
+            while (isContinuation(peek())) {
+                advance();
+            }
             m_bHadError = true;
-            ::nex::error(m_line, L"Unexpected wchar_tacter: " + std::wstring(1, c));
+            ::nex::error(m_line, "Unexpected character: " + std::string(m_source.substr(m_start, m_current - m_start)));
         }
     }
 }
 
-wchar_t Lexer::advance()
+char Lexer::advance()
 {
-    m_current++;
-    return m_source.at(m_current - 1);
+    return m_source[m_current++];
 }
 
 void Lexer::addToken(TokenType t)
@@ -127,19 +308,19 @@ void Lexer::addToken(TokenType t)
     addToken(t, nullptr);
 }
 
-void Lexer::addToken(TokenType t, std::any literal)
+void Lexer::addToken(TokenType t, Value literal)
 {
     auto text = m_source.substr(m_start, m_current - m_start);
-    m_tokens.push_back(Token(t, text, literal, m_line));
+    m_token.emplace(t, text, literal, m_line);
 }
 
-bool Lexer::match(wchar_t expected)
+bool Lexer::match(char expected)
 {
     if (isAtEnd()) {
         return false;
     }
 
-    if (m_source.at(m_current) != expected) {
+    if (m_source[m_current] != expected) {
         return false;
     }
 
@@ -147,61 +328,60 @@ bool Lexer::match(wchar_t expected)
     return true;
 }
 
-wchar_t Lexer::peek() const
+char Lexer::peek() const
 {
     if (isAtEnd()) {
         return '\0';
     }
-    return m_source.at(m_current);
+    return m_source[m_current];
 }
 
-wchar_t Lexer::peekNext() const
+char Lexer::peekNext() const
 {
     if (m_current + 1 >= m_source.size()) {
         return '\0';
     }
-    return m_source.at(m_current + 1);
+    return m_source[m_current + 1];
 }
 
 void Lexer::handleString()
 {
-    auto size = 0;
-    while (peek() != '"' && !isAtEnd()) {
-        if (peek() == '\n') m_line++;
-        advance();
-        size++;
-    }
+    const char* begin = m_source.data();
+    m_current = findByte(begin + m_current, begin + m_source.size(), '"', m_line) - begin;
 
     // Unterminated string
     if (isAtEnd()) {
-        ::nex::error(m_line, L"Unterminated string.");
+        m_bHadError = true;
+        ::nex::error(m_line, "Unterminated string.");
         return;
     }
 
     // The closing "
     advance();
 
-    auto value = m_source.substr(m_start + 1, size);
-    addToken(STRING, value);
+    auto value = m_source.substr(m_start + 1, m_current - m_start - 2);
+    addToken(STRING, SymbolTable::intern(value));
 }
 
 void Lexer::handleNumber()
 {
-    while (std::isdigit(peek())) {
+    while (isDigit(peek())) {
         advance();
     }
 
     // Look for a fractional part
-    if (peek() == '.' && std::isdigit(peekNext())) {
+    if (peek() == '.' && isDigit(peekNext())) {
         // Consume the "."
         advance();
 
-        while (std::isdigit(peek())) {
+        while (isDigit(peek())) {
             advance();
         }
     }
 
-    addToken(NUMBER, std::stod(m_source.substr(m_start, m_current - m_start)));
+    double number = 0;
+    std::from_chars(m_source.data() + m_start, m_source.data() + m_current, number);
+    addToken(NUMBER, number);
 }
 
 void Lexer::handleIdentifier()
@@ -210,25 +390,27 @@ void Lexer::handleIdentifier()
         advance();
     }
 
-    TokenType type = IDENTIFIER;
-    auto text = m_source.substr(m_start, m_current - m_start);
-    if (g_keywords.count(text) != 0) {
-        type = g_keywords.find(text)->second;
-    }
+    addToken(keywordType(m_source.substr(m_start, m_current - m_start)));
+}
 
-    addToken(type);
+bool Lexer::isAlpha(char c) const
+{
+    return g_charClasses[byte(c)] & CHAR_ALPHA;
 }
 
-bool Lexer::isAlpha(wchar_t c) const
+bool Lexer::isDigit(char c) const
 {
-    return (c >= 'a' && c < 'z') ||
-           (c >= 'A' && c < 'Z') ||
-            c == '_';
+    return g_charClasses[byte(c)] & CHAR_DIGIT;
 }
 
-bool Lexer::isAlphaNumeric(wchar_t c) const
+bool Lexer::isAlphaNumeric(char c) const
 {
-    return std::isdigit(c) || isAlpha(c);
+    return g_charClasses[byte(c)] & (CHAR_ALPHA | CHAR_DIGIT);
 }
 
-}
\ No newline at end of file
+bool Lexer::isContinuation(char c) const
+{
+    return (byte(c) & 0xC0) == 0x80;
+}
+
+}
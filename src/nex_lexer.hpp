@@ -1,10 +1,8 @@
 #ifndef NEX_LEXER_H_
 #define NEX_LEXER_H_
 
-#include <istream>
-#include <vector>
-#include <any>
-#include <map>
+#include <optional>
+#include <string_view>
 
 #include "nex_token.hpp"
 
@@ -13,33 +11,42 @@ namespace nex {
 class Lexer final
 {
 public:
-    explicit Lexer(std::wistream& is);
+    // Tokens view 'source', which must outlive them, see SourceFile
+    explicit Lexer(std::string_view source);
     ~Lexer() = default;
 
-    std::vector<Token> scan();
+    // The next token, pulled by the Parser as it goes. END_OF_FILE once the
+    // source is exhausted, and on every call after that.
+    Token next();
 
     inline bool error() const noexcept { return m_bHadError; }
 
 private:
     bool isAtEnd() const;
+    // Skips the whitespace and comments before the next token
+    void skipTrivia();
     void scanToken();
     void addToken(TokenType t);
-    void addToken(TokenType t, std::any literal);
-    wchar_t advance();
-    bool match(wchar_t next);
-    wchar_t peek() const;
-    wchar_t peekNext() const;
+    void addToken(TokenType t, Value literal);
+    char advance();
+    bool match(char next);
+    char peek() const;
+    char peekNext() const;
 
     void handleString();
     void handleNumber();
     void handleIdentifier();
 
-    bool isAlpha(wchar_t c) const;
-    bool isAlphaNumeric(wchar_t c) const;
+    bool isAlpha(char c) const;
+    bool isDigit(char c) const;
+    bool isAlphaNumeric(char c) const;
+    // Byte after the first of a UTF-8 encoded character
+    bool isContinuation(char c) const;
 
 private:
-    std::wstring m_source;
-    std::vector<Token> m_tokens;
+    std::string_view m_source;
+    // Token the last scanToken() call produced, if any
+    std::optional<Token> m_token;
     bool m_bHadError;
     size_t m_start;
     size_t m_current;
@@ -0,0 +1,173 @@
+#ifndef NEX_NATIVE_HPP
+#define NEX_NATIVE_HPP
+
+#include "nex_callable.hpp"
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace nex {
+
+// Error raised by a native function, the engine that called it reports it
+// at the call site
+class NativeError final
+{
+public:
+    explicit NativeError(std::string msg)
+        : m_msg(std::move(msg))
+    {}
+
+    inline const std::string& msg() const { return m_msg; }
+
+private:
+    std::string m_msg;
+};
+
+// Conversion of a C++ parameter or return type to and from Value, one
+// specialization per type a native function may use
+template <typename T>
+struct NativeType;
+
+template <>
+struct NativeType<double> {
+    static constexpr ValueType type = ValueType::NUMBER;
+    static inline double from(const Value& value) { return value.asNumber(); }
+    static inline Value to(double number) { return number; }
+};
+
+template <>
+struct NativeType<bool> {
+    static constexpr ValueType type = ValueType::BOOL;
+    static inline bool from(const Value& value) { return value.asBool(); }
+    static inline Value to(bool boolean) { return boolean; }
+};
+
+template <>
+struct NativeType<std::string> {
+    static constexpr ValueType type = ValueType::STRING;
+    static inline const std::string& from(const Value& value)
+    {
+        return value.asString()->str();
+    }
+    static inline Value to(const std::string& str) { return str; }
+};
+
+// Any value, passed through unchecked
+template <>
+struct NativeType<Value> {
+    static inline const Value& from(const Value& value) { return value; }
+    static inline Value to(Value value) { return value; }
+};
+
+// A C++ function callable from scripts. The function is wrapped by a thunk
+// generated for its signature, which checks and unboxes the arguments in
+// place and boxes the result, see makeNative.
+class NativeFunction final : public NexCallable
+{
+public:
+    using Thunk = Value (*)(const NativeFunction& self, Arguments arguments);
+
+    NativeFunction(std::string name, size_t arity, Thunk thunk)
+        : m_name(std::move(name))
+        , m_arity(arity)
+        , m_thunk(thunk)
+    {}
+
+    ~NativeFunction() = default;
+
+    inline Value call(Interpreter* interp, Arguments arguments) override
+    {
+        (void) interp;
+        return m_thunk(*this, arguments);
+    }
+
+    inline size_t arity() const override
+    {
+        return m_arity;
+    }
+
+    inline std::string to_string() const override
+    {
+        return "<native func '" + m_name + "'>";
+    }
+
+    inline std::string name() const override
+    {
+        return m_name;
+    }
+
+    [[noreturn]] void badArgument(size_t index, ValueType expected, const Value& got) const
+    {
+        throw NativeError("'" + m_name + "' expected a " + Value::typeName(expected) +
+                          " as argument " + std::to_string(index + 1) +
+                          " but got " + Value::typeName(got.type()) + ".");
+    }
+
+private:
+    std::string m_name;
+    size_t m_arity;
+    Thunk m_thunk;
+};
+
+namespace detail {
+
+template <typename T>
+using NativeArg = NativeType<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+template <typename T>
+inline void checkNativeArg(const NativeFunction& self, Arguments arguments, size_t index)
+{
+    if constexpr (!std::is_same_v<std::remove_cv_t<std::remove_reference_t<T>>, Value>) {
+        if (arguments[index].type() != NativeArg<T>::type) {
+            self.badArgument(index, NativeArg<T>::type, arguments[index]);
+        }
+    }
+}
+
+template <typename Signature>
+struct NativeThunk;
+
+template <typename R, typename... Args>
+struct NativeThunk<R (*)(Args...)> {
+    static constexpr size_t arity = sizeof...(Args);
+
+    template <R (*F)(Args...), size_t... I>
+    static inline Value invoke(const NativeFunction& self,
+                               Arguments arguments,
+                               std::index_sequence<I...>)
+    {
+        (void) self;
+        (void) arguments;
+        (checkNativeArg<Args>(self, arguments, I), ...);
+        if constexpr (std::is_void_v<R>) {
+            F(NativeArg<Args>::from(arguments[I])...);
+            return Value();
+        } else {
+            return NativeArg<R>::to(F(NativeArg<Args>::from(arguments[I])...));
+        }
+    }
+
+    template <R (*F)(Args...)>
+    static Value thunk(const NativeFunction& self, Arguments arguments)
+    {
+        return invoke<F>(self, arguments, std::index_sequence_for<Args...>{});
+    }
+};
+
+}
+
+// Wraps the C++ function 'F' as the native function 'name'. Its arity and
+// the argument checks come from its signature at compile time, parameters
+// and result may be double, bool, std::string or Value, void returns nil.
+template <auto F>
+inline Ref<NativeFunction> makeNative(const char* name)
+{
+    using Thunk = detail::NativeThunk<decltype(F)>;
+    return make_ref<NativeFunction>(name, Thunk::arity, &Thunk::template thunk<F>);
+}
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef NEX_OBJECT_HPP
+#define NEX_OBJECT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace nex {
+
+class Heap;
+
+// Base class of every heap allocated runtime value (strings, callables,
+// classes and instances). The reference count is intrusive and non-atomic,
+// the interpreter is single threaded. Objects that can take part in a
+// reference cycle derive from HeapObject instead, see nex_heap.hpp.
+class Object
+{
+public:
+    Object() = default;
+    Object(const Object&) = delete;
+    Object& operator=(const Object&) = delete;
+
+    virtual ~Object() = default;
+
+    inline void retain()
+    {
+        m_refCount++;
+    }
+
+    inline void release()
+    {
+        if (--m_refCount == 0) {
+            delete this;
+        }
+    }
+
+    inline uint32_t refCount() const
+    {
+        return m_refCount;
+    }
+
+    // Allocated by the Heap, which traces it when it collects cycles
+    inline bool tracked() const
+    {
+        return m_bTracked;
+    }
+
+private:
+    friend class Heap;
+
+    uint32_t m_refCount = 0;
+    bool m_bTracked = false;
+};
+
+// Owning pointer to an Object
+template <typename T>
+class Ref final
+{
+public:
+    Ref() : m_ptr(nullptr) {}
+    Ref(std::nullptr_t) : m_ptr(nullptr) {}
+
+    Ref(T* ptr) : m_ptr(ptr)
+    {
+        if (m_ptr) m_ptr->retain();
+    }
+
+    Ref(const Ref& other) : Ref(other.m_ptr) {}
+
+    Ref(Ref&& other) noexcept : m_ptr(other.m_ptr)
+    {
+        other.m_ptr = nullptr;
+    }
+
+    template <typename U>
+    Ref(const Ref<U>& other) : Ref(other.get()) {}
+
+    ~Ref()
+    {
+        if (m_ptr) m_ptr->release();
+    }
+
+    Ref& operator=(Ref other) noexcept
+    {
+        std::swap(m_ptr, other.m_ptr);
+        return *this;
+    }
+
+    inline T* get() const { return m_ptr; }
+    inline T* operator->() const { return m_ptr; }
+    inline T& operator*() const { return *m_ptr; }
+    inline explicit operator bool() const { return m_ptr != nullptr; }
+
+private:
+    T* m_ptr;
+};
+
+template <typename T, typename ...Args>
+inline Ref<T> make_ref(Args&& ...args)
+{
+    return Ref<T>(new T(std::forward<Args>(args)...));
+}
+
+}
+
+#endif
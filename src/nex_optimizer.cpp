@@ -0,0 +1,352 @@
+#include "nex_optimizer.hpp"
+#include "nex_symbol.hpp"
+
+namespace nex {
+
+Optimizer::Optimizer(Arena& arena)
+    : m_arena(arena)
+    , m_pExpr(nullptr)
+    , m_pStmt(nullptr)
+{}
+
+ArenaList<stmt::Stmt*> Optimizer::optimize(ArenaList<stmt::Stmt*> statements)
+{
+    return simplify(statements);
+}
+
+void Optimizer::visitBlockStmt(stmt::Block* stmt)
+{
+    stmt->m_statements = simplify(stmt->m_statements);
+    m_pStmt = stmt;
+}
+
+void Optimizer::visitClassStmt(stmt::Class* stmt)
+{
+    for (auto field : stmt->m_fields) {
+        visitLetStmt(field);
+    }
+
+    for (auto method : stmt->m_methods) {
+        visitFunctionStmt(method);
+    }
+
+    m_pStmt = stmt;
+}
+
+void Optimizer::visitExpressionStmt(stmt::Expression* stmt)
+{
+    stmt->m_e = fold(stmt->m_e);
+}
+
+void Optimizer::visitFunctionStmt(stmt::Function* stmt)
+{
+    stmt->m_body = simplify(stmt->m_body);
+    m_pStmt = stmt;
+}
+
+void Optimizer::visitIfStmt(stmt::If* stmt)
+{
+    stmt->m_cond = fold(stmt->m_cond);
+
+    // Only the branch that runs is kept
+    if (auto pCond = asLiteral(stmt->m_cond)) {
+        if (pCond->m_value.isTruthy()) {
+            m_pStmt = simplify(stmt->m_thenBranch);
+        }
+        else {
+            m_pStmt = stmt->m_elseBranch ? simplify(stmt->m_elseBranch) : nullptr;
+        }
+        return;
+    }
+
+    stmt->m_thenBranch = simplifyBranch(stmt->m_thenBranch);
+    if (stmt->m_elseBranch) {
+        stmt->m_elseBranch = simplify(stmt->m_elseBranch);
+    }
+    m_pStmt = stmt;
+}
+
+void Optimizer::visitPrintStmt(stmt::Print* stmt)
+{
+    stmt->m_e = fold(stmt->m_e);
+}
+
+void Optimizer::visitReturnStmt(stmt::Return* stmt)
+{
+    if (stmt->m_value) {
+        stmt->m_value = fold(stmt->m_value);
+    }
+}
+
+void Optimizer::visitLetStmt(stmt::Let* stmt)
+{
+    if (stmt->m_init) {
+        stmt->m_init = fold(stmt->m_init);
+    }
+}
+
+void Optimizer::visitWhileStmt(stmt::While* stmt)
+{
+    stmt->m_cond = fold(stmt->m_cond);
+
+    // A loop whose condition is a falsy constant never runs
+    auto pCond = asLiteral(stmt->m_cond);
+    if (pCond && !pCond->m_value.isTruthy()) {
+        m_pStmt = nullptr;
+        return;
+    }
+
+    stmt->m_body = simplifyBranch(stmt->m_body);
+    m_pStmt = stmt;
+}
+
+Value Optimizer::visitAssignExpr(expr::Assign* expr)
+{
+    expr->m_value = fold(expr->m_value);
+    m_pExpr = expr;
+    return nullptr;
+}
+
+Value Optimizer::visitBinaryExpr(expr::Binary* expr)
+{
+    expr->m_left = fold(expr->m_left);
+    expr->m_right = fold(expr->m_right);
+    m_pExpr = expr;
+
+    auto pLeft = asLiteral(expr->m_left);
+    auto pRight = asLiteral(expr->m_right);
+    if (!pLeft || !pRight) {
+        return nullptr;
+    }
+
+    // Mirrors Interpreter::visitBinaryExpr, operands it would reject are not
+    // folded
+    const auto& left = pLeft->m_value;
+    const auto& right = pRight->m_value;
+    auto bNumbers = left.isNumber() && right.isNumber();
+    switch (expr->m_op.m_type) {
+    case GREATER:
+        if (bNumbers) {
+            replaceWith(left.asNumber() > right.asNumber());
+        }
+        break;
+    case GREATER_EQUAL:
+        if (bNumbers) {
+            replaceWith(left.asNumber() >= right.asNumber());
+        }
+        break;
+    case LESS:
+        if (bNumbers) {
+            replaceWith(left.asNumber() < right.asNumber());
+        }
+        break;
+    case LESS_EQUAL:
+        if (bNumbers) {
+            replaceWith(left.asNumber() <= right.asNumber());
+        }
+        break;
+    case MINUS:
+        if (bNumbers) {
+            replaceWith(left.asNumber() - right.asNumber());
+        }
+        break;
+    case SLASH:
+        // Division by zero is left for the interpreter to report
+        if (bNumbers && right.asNumber() != 0) {
+            replaceWith(left.asNumber() / right.asNumber());
+        }
+        break;
+    case STAR:
+        if (bNumbers) {
+            replaceWith(left.asNumber() * right.asNumber());
+        }
+        break;
+    case PLUS:
+        if (bNumbers) {
+            replaceWith(left.asNumber() + right.asNumber());
+        }
+        else if (left.isString() && right.isString()) {
+            // Interned like the string literals the lexer produces
+            replaceWith(SymbolTable::intern(left.asString()->str() + right.asString()->str()));
+        }
+        break;
+    case BANG_EQUAL:
+        replaceWith(left != right);
+        break;
+    case EQUAL_EQUAL:
+        replaceWith(left == right);
+        break;
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+Value Optimizer::visitCallExpr(expr::Call* expr)
+{
+    expr->m_callee = fold(expr->m_callee);
+    for (size_t idx = 0; idx < expr->m_arguments.size(); idx++) {
+        expr->m_arguments[idx] = fold(expr->m_arguments[idx]);
+    }
+    m_pExpr = expr;
+    return nullptr;
+}
+
+Value Optimizer::visitGetExpr(expr::Get* expr)
+{
+    expr->m_object = fold(expr->m_object);
+    m_pExpr = expr;
+    return nullptr;
+}
+
+Value Optimizer::visitSetExpr(expr::Set* expr)
+{
+    expr->m_object = fold(expr->m_object);
+    expr->m_value = fold(expr->m_value);
+    m_pExpr = expr;
+    return nullptr;
+}
+
+Value Optimizer::visitSuperExpr(expr::Super* expr)
+{
+    (void) expr;
+    return nullptr;
+}
+
+Value Optimizer::visitThisExpr(expr::This* expr)
+{
+    (void) expr;
+    return nullptr;
+}
+
+Value Optimizer::visitGroupingExpr(expr::Grouping* expr)
+{
+    // Parentheses only matter to the parser
+    m_pExpr = fold(expr->m_expression);
+    return nullptr;
+}
+
+Value Optimizer::visitLiteralExpr(expr::Literal* expr)
+{
+    (void) expr;
+    return nullptr;
+}
+
+Value Optimizer::visitLogicalExpr(expr::Logical* expr)
+{
+    expr->m_left = fold(expr->m_left);
+    expr->m_right = fold(expr->m_right);
+    m_pExpr = expr;
+
+    // 'or' yields its left operand when it is truthy, 'and' when it is falsy,
+    // otherwise both yield their right operand
+    if (auto pLeft = asLiteral(expr->m_left)) {
+        if (pLeft->m_value.isTruthy() == (expr->m_op.m_type == OR)) {
+            m_pExpr = pLeft;
+        }
+        else {
+            m_pExpr = expr->m_right;
+        }
+    }
+
+    return nullptr;
+}
+
+Value Optimizer::visitUnaryExpr(expr::Unary* expr)
+{
+    expr->m_right = fold(expr->m_right);
+    m_pExpr = expr;
+
+    auto pRight = asLiteral(expr->m_right);
+    if (!pRight) {
+        return nullptr;
+    }
+
+    const auto& right = pRight->m_value;
+    switch (expr->m_op.m_type) {
+    case BANG:
+        replaceWith(!right.isTruthy());
+        break;
+    case MINUS:
+        if (right.isNumber()) {
+            replaceWith(-right.asNumber());
+        }
+        break;
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+Value Optimizer::visitCommaExpr(expr::Comma* expr)
+{
+    for (size_t idx = 0; idx < expr->m_exprs.size(); idx++) {
+        expr->m_exprs[idx] = fold(expr->m_exprs[idx]);
+    }
+    expr->m_last = fold(expr->m_last);
+    m_pExpr = expr;
+    return nullptr;
+}
+
+Value Optimizer::visitVariableExpr(expr::Variable* expr)
+{
+    (void) expr;
+    return nullptr;
+}
+
+Value Optimizer::visitInputExpr(expr::Input* expr)
+{
+    (void) expr;
+    return nullptr;
+}
+
+expr::Expr* Optimizer::fold(expr::Expr* e)
+{
+    m_pExpr = e;
+    e->accept(this);
+    return m_pExpr;
+}
+
+stmt::Stmt* Optimizer::simplify(stmt::Stmt* s)
+{
+    m_pStmt = s;
+    s->accept(this);
+    return m_pStmt;
+}
+
+stmt::Stmt* Optimizer::simplifyBranch(stmt::Stmt* s)
+{
+    if (auto pSimplified = simplify(s)) {
+        return pSimplified;
+    }
+
+    return stmt::make_block(m_arena, ArenaList<stmt::Stmt*>());
+}
+
+ArenaList<stmt::Stmt*> Optimizer::simplify(ArenaList<stmt::Stmt*> statements)
+{
+    // Compacted in place, removed statements only ever shorten the list
+    size_t count = 0;
+    for (size_t idx = 0; idx < statements.size(); idx++) {
+        if (auto s = simplify(statements[idx])) {
+            statements[count++] = s;
+        }
+    }
+
+    statements.shrink(count);
+    return statements;
+}
+
+void Optimizer::replaceWith(const Value& value)
+{
+    m_pExpr = expr::make_literal(m_arena, value);
+}
+
+expr::Literal* Optimizer::asLiteral(expr::Expr* e)
+{
+    return dynamic_cast<expr::Literal*>(e);
+}
+
+} // namespace nex
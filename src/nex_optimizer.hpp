@@ -0,0 +1,83 @@
+#ifndef NEX_OPTIMIZER_HPP
+#define NEX_OPTIMIZER_HPP
+
+#include "nex_arena.hpp"
+#include "nex_expr.hpp"
+#include "nex_stmt.hpp"
+
+namespace nex
+{
+
+using namespace nex::ast;
+
+// Pass over the resolved AST, run before the program executes. It folds
+// operations on literals into a single literal, removes groupings and
+// replaces 'if' statements whose condition is a constant with the branch
+// that runs. Operations that would raise a runtime error (division by zero,
+// operands of the wrong type) are left in place so the error still happens
+// when, and if, they run.
+//
+// The tree is rewritten in place. Variable, Assign, This and Super nodes are
+// never replaced, so what the Resolver recorded about them stays valid.
+class Optimizer final : public stmt::Visitor, public expr::Visitor
+{
+public:
+    // New nodes are allocated in 'arena', the one the program was parsed into
+    explicit Optimizer(Arena& arena);
+    ~Optimizer() = default;
+
+    // Returns the optimized program, statements that can never run are dropped
+    ArenaList<stmt::Stmt*> optimize(ArenaList<stmt::Stmt*> statements);
+
+    void visitBlockStmt(stmt::Block* stmt) override;
+    void visitClassStmt(stmt::Class* stmt) override;
+    void visitExpressionStmt(stmt::Expression* stmt) override;
+    void visitFunctionStmt(stmt::Function* stmt) override;
+    void visitIfStmt(stmt::If* stmt) override;
+    void visitPrintStmt(stmt::Print* stmt) override;
+    void visitReturnStmt(stmt::Return* stmt) override;
+    void visitLetStmt(stmt::Let* stmt) override;
+    void visitWhileStmt(stmt::While* stmt) override;
+
+    Value visitAssignExpr(expr::Assign* expr) override;
+    Value visitBinaryExpr(expr::Binary* expr) override;
+    Value visitCallExpr(expr::Call* expr) override;
+    Value visitGetExpr(expr::Get* expr) override;
+    Value visitSetExpr(expr::Set* expr) override;
+    Value visitSuperExpr(expr::Super* expr) override;
+    Value visitThisExpr(expr::This* expr) override;
+    Value visitGroupingExpr(expr::Grouping* expr) override;
+    Value visitLiteralExpr(expr::Literal* expr) override;
+    Value visitLogicalExpr(expr::Logical* expr) override;
+    Value visitUnaryExpr(expr::Unary* expr) override;
+    Value visitCommaExpr(expr::Comma* expr) override;
+    Value visitVariableExpr(expr::Variable* expr) override;
+    Value visitInputExpr(expr::Input* expr) override;
+
+private:
+    // The node that replaces 'e', 'e' itself when nothing was folded
+    expr::Expr* fold(expr::Expr* e);
+
+    // The statement that replaces 's', nullptr when it can never run
+    stmt::Stmt* simplify(stmt::Stmt* s);
+
+    // Same as above for a statement that cannot be removed, such as the
+    // branch of an 'if'
+    stmt::Stmt* simplifyBranch(stmt::Stmt* s);
+
+    ArenaList<stmt::Stmt*> simplify(ArenaList<stmt::Stmt*> statements);
+
+    // Replaces the visited expression with a literal holding 'value'
+    void replaceWith(const Value& value);
+
+    static expr::Literal* asLiteral(expr::Expr* e);
+
+    Arena& m_arena;
+    // Replacement of the expression and of the statement being visited
+    expr::Expr* m_pExpr;
+    stmt::Stmt* m_pStmt;
+};
+
+} // namespace nex
+
+#endif
@@ -3,7 +3,7 @@
 
 namespace nex {
 
-std::vector<StmtPointer> Parser::parse()
+ArenaList<StmtPointer> Parser::parse()
 {
     std::vector<StmtPointer> stmts;
     try {
@@ -12,9 +12,9 @@ std::vector<StmtPointer> Parser::parse()
         }
     } catch (const std::runtime_error e) {
         m_bHadError = false;
-        return stmts;
+        return m_arena.list(stmts);
     }
-    return stmts;
+    return m_arena.list(stmts);
 }
 
 StmtPointer Parser::declaration()
@@ -25,7 +25,7 @@ StmtPointer Parser::declaration()
         }
 
         if (match(FUNC)) {
-            return function(L"function");
+            return function("function");
         }
 
         if (match(LET)) {
@@ -41,69 +41,69 @@ StmtPointer Parser::declaration()
 
 StmtPointer Parser::classDeclaration()
 {
-    auto name = consume(IDENTIFIER, L"Expect class name.");
+    auto name = consume(IDENTIFIER, "Expect class name.");
 
-    std::shared_ptr<Variable> superclass = nullptr;
+    Variable* superclass = nullptr;
     if (match(EXTENDS)) {
-        consume(IDENTIFIER, L"Expect superclass name.");
-        superclass = std::dynamic_pointer_cast<Variable>(make_variable(previous()));
+        consume(IDENTIFIER, "Expect superclass name.");
+        superclass = make_variable(m_arena, previous());
     }
 
-    consume(LEFT_BRACE, L"Expect '{' before class body");
+    consume(LEFT_BRACE, "Expect '{' before class body");
 
-    std::vector<std::shared_ptr<Function>> methods;
-    std::vector<std::shared_ptr<Let>> fields;
+    std::vector<Function*> methods;
+    std::vector<Let*> fields;
     while (!check(RIGHT_BRACE) && !isAtEnd()) {
         if (match(LET)) {
-            fields.push_back(std::dynamic_pointer_cast<Let>(letDeclaration()));
+            fields.push_back(static_cast<Let*>(letDeclaration()));
         }
         else if (match(FUNC)) {
-            methods.push_back(std::dynamic_pointer_cast<Function>(function(L"method")));
+            methods.push_back(static_cast<Function*>(function("method")));
         }
         else {
-            throw error(peek(), L"Unexpected token '" + peek().m_lexeme + L"'.");
+            throw error(peek(), "Unexpected token '" + std::string(peek().m_lexeme) + "'.");
         }
     }
 
-    consume(RIGHT_BRACE, L"Expect '}' after class body");
-    return make_class(name, superclass, methods, fields);
+    consume(RIGHT_BRACE, "Expect '}' after class body");
+    return make_class(m_arena, name, superclass, m_arena.list(methods), m_arena.list(fields));
 }
 
-StmtPointer Parser::function(const std::wstring& kind)
+StmtPointer Parser::function(const std::string& kind)
 {
-    auto name = consume(IDENTIFIER, L"Expect " + kind + L" name.");
+    auto name = consume(IDENTIFIER, "Expect " + kind + " name.");
 
-    consume(LEFT_PAREN, L"Expect '(' after " + kind + L" name.");
+    consume(LEFT_PAREN, "Expect '(' after " + kind + " name.");
 
-    std::vector<Token> parameters;
+    std::vector<SlimToken> parameters;
     if (!check(RIGHT_PAREN)) {
         do {
             if (parameters.size() >= 255) {
-                error(peek(), L"Cannot have more than 255 parameters");
+                error(peek(), "Cannot have more than 255 parameters");
             }
 
-            parameters.push_back(consume(IDENTIFIER, L"Expect parameter name."));
+            parameters.push_back(consume(IDENTIFIER, "Expect parameter name."));
         } while (match(COMMA));
     }
-    consume(RIGHT_PAREN, L"Expect ')' after parameters");
+    consume(RIGHT_PAREN, "Expect ')' after parameters");
 
-    consume(LEFT_BRACE, L"Expect '}' before " + kind + L" body.");
+    consume(LEFT_BRACE, "Expect '}' before " + kind + " body.");
     auto body = block();
 
-    return make_function(name, parameters, body);
+    return make_function(m_arena, name, m_arena.list(parameters), m_arena.list(body));
 }
 
 StmtPointer Parser::letDeclaration()
 {
-    Token name = consume(IDENTIFIER, L"Expect variable name");
+    Token name = consume(IDENTIFIER, "Expect variable name");
 
     ExprPointer init = nullptr;
     if (match(EQUAL)) {
         init = expression();
     }
 
-    consume(SEMICOLON, L"Expect ';' after variable declaration");
-    return make_let(name, init);
+    consume(SEMICOLON, "Expect ';' after variable declaration");
+    return make_let(m_arena, name, init);
 }
 
 StmtPointer Parser::statement()
@@ -130,7 +130,7 @@ StmtPointer Parser::statement()
 
     if (match(LEFT_BRACE)) {
         auto b = block();
-        return make_block(b);
+        return make_block(m_arena, m_arena.list(b));
     }
 
     return expressionStatement();
@@ -138,7 +138,7 @@ StmtPointer Parser::statement()
 
 StmtPointer Parser::forStatement()
 {
-    consume(LEFT_PAREN, L"Expect '(' after 'for'.");
+    consume(LEFT_PAREN, "Expect '(' after 'for'.");
     StmtPointer init;
     if (match(SEMICOLON)) {
         init = nullptr;
@@ -153,31 +153,31 @@ StmtPointer Parser::forStatement()
         cond = expression();
     }
 
-    consume(SEMICOLON, L"Expect ';' after loop condition");
+    consume(SEMICOLON, "Expect ';' after loop condition");
 
     ExprPointer increment = nullptr;
     if (!check(RIGHT_PAREN)) {
         increment = expression();
     }
-    consume(RIGHT_PAREN, L"Expect ')' after for clauses");
+    consume(RIGHT_PAREN, "Expect ')' after for clauses");
 
     StmtPointer body = statement();
 
     // Extand the syntatic sugar of a for-loop to a while-loop:
     if(increment != nullptr) {
-        body = make_block({
+        body = make_block(m_arena, m_arena.list<StmtPointer>({
             body,
-            make_expression(increment),
-        });
+            make_expression(m_arena, increment),
+        }));
     }
 
     if (cond == nullptr) {
-        cond = make_literal(true);
+        cond = make_literal(m_arena, true);
     }
-    body = make_while(cond, body);
+    body = make_while(m_arena, cond, body);
 
     if (init != nullptr) {
-        body = make_block({ init, body });
+        body = make_block(m_arena, m_arena.list<StmtPointer>({ init, body }));
     }
 
     return body;
@@ -185,9 +185,9 @@ StmtPointer Parser::forStatement()
 
 StmtPointer Parser::ifStatement()
 {
-    consume(LEFT_PAREN, L"Expect '(' after 'if'.");
+    consume(LEFT_PAREN, "Expect '(' after 'if'.");
     auto cond = expression();
-    consume(RIGHT_PAREN, L"Expect ')' after if condition.");
+    consume(RIGHT_PAREN, "Expect ')' after if condition.");
 
     auto thenBranch = statement();
 
@@ -196,7 +196,7 @@ StmtPointer Parser::ifStatement()
         elseBranch = statement();
     }
 
-    return make_if(cond, thenBranch, elseBranch);
+    return make_if(m_arena, cond, thenBranch, elseBranch);
 }
 
 std::vector<StmtPointer> Parser::block()
@@ -207,17 +207,17 @@ std::vector<StmtPointer> Parser::block()
         statements.push_back(declaration());
     }
 
-    consume(RIGHT_BRACE, L"Expect '}' after block.");
+    consume(RIGHT_BRACE, "Expect '}' after block.");
     return statements;
 }
 
 StmtPointer Parser::printStatement()
 {
-    consume(LEFT_PAREN, L"Expect '(' before function call");
+    consume(LEFT_PAREN, "Expect '(' before function call");
     auto expr = expression();
-    consume(RIGHT_PAREN, L"Expect ')' after function call");
-    consume(SEMICOLON, L"Expect ';' after value");
-    return make_print(expr);
+    consume(RIGHT_PAREN, "Expect ')' after function call");
+    consume(SEMICOLON, "Expect ';' after value");
+    return make_print(m_arena, expr);
 }
 
 StmtPointer Parser::returnStatement()
@@ -228,32 +228,32 @@ StmtPointer Parser::returnStatement()
         value = expression();
     }
 
-    consume(SEMICOLON, L"Expect ';' after return value");
-    return make_return(keyword, value);
+    consume(SEMICOLON, "Expect ';' after return value");
+    return make_return(m_arena, keyword, value);
 }
 
 StmtPointer Parser::whileStatement()
 {
-    consume(LEFT_PAREN, L"Expect '(' after 'while'.");
+    consume(LEFT_PAREN, "Expect '(' after 'while'.");
     auto cond = expression();
-    consume(RIGHT_PAREN, L"Expect ')' after condition.");
+    consume(RIGHT_PAREN, "Expect ')' after condition.");
     auto stmt = statement();
 
-    return make_while(cond, stmt);
+    return make_while(m_arena, cond, stmt);
 }
 
 ExprPointer Parser::inputExpr()
 {
-    consume(LEFT_PAREN, L"Expect '(' before function call");
-    consume(RIGHT_PAREN, L"Expect ')' after function call");
-    return make_input(nullptr);
+    consume(LEFT_PAREN, "Expect '(' before function call");
+    consume(RIGHT_PAREN, "Expect ')' after function call");
+    return make_input(m_arena, nullptr);
 }
 
 StmtPointer Parser::expressionStatement()
 {
     auto expr = expression();
-    consume(SEMICOLON, L"Expect ';' after expression.");
-    return make_expression(expr);
+    consume(SEMICOLON, "Expect ';' after expression.");
+    return make_expression(m_arena, expr);
 }
 
 ExprPointer Parser::assignment()
@@ -264,15 +264,14 @@ ExprPointer Parser::assignment()
         auto equals = previous();
         auto value = assignment();
 
-        if (auto pVar = std::dynamic_pointer_cast<Variable>(expr)) {
-            auto name = pVar->m_name;
-            return make_assign(name, value);
+        if (auto pVar = dynamic_cast<Variable*>(expr)) {
+            return make_assign(m_arena, pVar->m_name, value);
         }
-        else if (auto pGet = std::dynamic_pointer_cast<Get>(expr)) {
-            return make_set(pGet->m_object, pGet->m_name, value);
+        else if (auto pGet = dynamic_cast<Get*>(expr)) {
+            return make_set(m_arena, pGet->m_object, pGet->m_name, value);
         }
 
-        error(equals, L"Invalid assignment target.");
+        error(equals, "Invalid assignment target.");
     }
 
     return expr;
@@ -285,7 +284,7 @@ ExprPointer Parser::orExpr()
     while (match(OR)) {
         auto op = previous();
         auto right = andExpr();
-        expr = make_logical(expr, op, right);
+        expr = make_logical(m_arena, expr, op, right);
     }
 
     return expr;
@@ -298,7 +297,7 @@ ExprPointer Parser::andExpr()
     while (match(AND)) {
         auto op = previous();
         auto right = equality();
-        expr = make_logical(expr, op, right);
+        expr = make_logical(m_arena, expr, op, right);
     }
 
     return expr;
@@ -316,7 +315,7 @@ ExprPointer Parser::equality()
     while (match(BANG_EQUAL, EQUAL_EQUAL)) {
         auto op = previous();
         auto right = comparison();
-        expr = make_binary(expr, op, right);
+        expr = make_binary(m_arena, expr, op, right);
     }
 
     return expr;
@@ -329,7 +328,7 @@ ExprPointer Parser::comparison()
     while (match(GREATER, GREATER_EQUAL, LESS, LESS_EQUAL)) {
         auto op = previous();
         auto right = addition();
-        expr = make_binary(expr, op, right);
+        expr = make_binary(m_arena, expr, op, right);
     }
 
     return expr;
@@ -342,7 +341,7 @@ ExprPointer Parser::addition()
     while (match(MINUS, PLUS)) {
         auto op = previous();
         auto right = multiplication();
-        expr = make_binary(expr, op, right);
+        expr = make_binary(m_arena, expr, op, right);
     }
 
     return expr;
@@ -355,7 +354,7 @@ ExprPointer Parser::multiplication()
     while (match(SLASH, STAR)) {
         auto op = previous();
         auto right = unary();
-        expr = make_binary(expr, op, right);
+        expr = make_binary(m_arena, expr, op, right);
     }
 
     return expr;
@@ -366,7 +365,7 @@ ExprPointer Parser::unary()
     if (match(BANG, MINUS)) {
         auto op = previous();
         auto right = unary();
-        return make_unary(op, right);
+        return make_unary(m_arena, op, right);
     }
 
     return call();
@@ -380,8 +379,8 @@ ExprPointer Parser::call()
         if (match(LEFT_PAREN)) {
             expr = finishCall(expr);
         } else if (match(DOT)) {
-            auto name = consume(IDENTIFIER, L"Expect property name after '.'");
-            expr = make_get(expr, name);
+            auto name = consume(IDENTIFIER, "Expect property name after '.'");
+            expr = make_get(m_arena, expr, name);
         } else {
             break;
         }
@@ -396,33 +395,33 @@ ExprPointer Parser::finishCall(ExprPointer e)
     if (!check(RIGHT_PAREN)) {
         do {
             if (arguments.size() >= 255) {
-                error(peek(), L"Cannot have more than 255 arguments.");
+                error(peek(), "Cannot have more than 255 arguments.");
             }
             arguments.push_back(expression());
         } while (match(COMMA));
     }
 
-    Token paren = consume(RIGHT_PAREN, L"Expect ')' after arguments.");
+    auto paren = consume(RIGHT_PAREN, "Expect ')' after arguments.");
 
-    return make_call(e, paren, arguments);
+    return make_call(m_arena, e, paren, m_arena.list(arguments));
 }
 
 ExprPointer Parser::primary()
 {
     if (match(FALSE)) {
-        return make_literal(false);
+        return make_literal(m_arena, false);
     }
 
     if (match(TRUE)) {
-        return make_literal(true);
+        return make_literal(m_arena, true);
     }
 
     if (match(NIL)) {
-        return make_literal(nullptr);
+        return make_literal(m_arena, nullptr);
     }
 
     if (match(NUMBER, STRING)) {
-        return make_literal(previous().m_literal);
+        return make_literal(m_arena, previous().m_literal);
     }
 
     if (match(LEFT_PAREN)) {
@@ -441,12 +440,12 @@ ExprPointer Parser::primary()
                     break;
                 }
             }
-            consume(RIGHT_PAREN, L"Expect ')' after expression");
-            return make_comma(es, last);
+            consume(RIGHT_PAREN, "Expect ')' after expression");
+            return make_comma(m_arena, m_arena.list(es), last);
         }
         else {
-            consume(RIGHT_PAREN, L"Expect ')' after expression");
-            return make_grouping(expr);
+            consume(RIGHT_PAREN, "Expect ')' after expression");
+            return make_grouping(m_arena, expr);
         }
     }
 
@@ -456,20 +455,20 @@ ExprPointer Parser::primary()
 
     if (match(SUPER)) {
         auto keyword = previous();
-        consume(DOT, L"Expect '.' after 'super'.");
-        auto method = consume(IDENTIFIER, L"Expect superclass method name");
-        return make_super(keyword, method);
+        consume(DOT, "Expect '.' after 'super'.");
+        auto method = consume(IDENTIFIER, "Expect superclass method name");
+        return make_super(m_arena, keyword, method);
     }
 
     if (match(THIS)) {
-        return make_this(previous());
+        return make_this(m_arena, previous());
     }
 
     if (match(IDENTIFIER)) {
-        return make_variable(previous());
+        return make_variable(m_arena, previous());
     }
 
-    throw error(peek(), L"Expect expression");
+    throw error(peek(), "Expect expression");
 }
 
 ExprPointer Parser::comma(ExprPointer e)
@@ -478,7 +477,7 @@ ExprPointer Parser::comma(ExprPointer e)
     return nullptr;
 }
 
-Token Parser::consume(TokenType type, std::wstring msg)
+const Token& Parser::consume(TokenType type, std::string msg)
 {
     if (check(type)) {
         return advance();
@@ -487,20 +486,24 @@ Token Parser::consume(TokenType type, std::wstring msg)
     throw error(peek(), msg);
 }
 
-void Parser::reportError(Token token, std::wstring msg)
+void Parser::reportError(const Token& token, std::string msg)
 {
     if (token.m_type == END_OF_FILE) {
-        ::nex::report(token.m_line, L" at end", msg);
+        ::nex::report(token.m_line, " at end", msg);
     }
     else {
-        ::nex::report(token.m_line, L" at '" + token.m_lexeme + L"'", msg);
+        ::nex::report(token.m_line, " at '" + std::string(token.m_lexeme) + "'", msg);
     }
 }
-ParserError Parser::error(Token token, std::wstring msg)
+ParserError Parser::error(const Token& token, std::string msg)
 {
     m_bHadError = true;
-    ::nex::report(token.m_line, L"", msg);
-    return ParserError(L"");
+    // The tokens after a lexer error are not what the script says, the
+    // errors they cause are not reported
+    if (!m_lexer.error()) {
+        ::nex::report(token.m_line, "", msg);
+    }
+    return ParserError("");
 }
 
 bool Parser::check(TokenType type)
@@ -512,10 +515,12 @@ bool Parser::check(TokenType type)
     return peek().m_type == type;
 }
 
-Token Parser::advance()
+const Token& Parser::advance()
 {
     if (!isAtEnd()) {
-        m_current++;
+        // The slot of the previous token takes the next one
+        m_window[m_current ^ 1].emplace(m_lexer.next());
+        m_current ^= 1;
     }
     return previous();
 }
@@ -1,10 +1,13 @@
 #ifndef NEX_PARSER_HPP_
 #define NEX_PARSER_HPP_
 
+#include "nex_arena.hpp"
+#include "nex_lexer.hpp"
 #include "nex_token.hpp"
 #include "nex_expr.hpp"
 #include "nex_stmt.hpp"
 
+#include <optional>
 #include <vector>
 
 namespace nex {
@@ -12,35 +15,42 @@ namespace nex {
 using namespace ast::expr;
 using namespace ast::stmt;
 
-using ExprPointer = std::shared_ptr<Expr>;
-using StmtPointer = std::shared_ptr<Stmt>;
+using ExprPointer = Expr*;
+using StmtPointer = Stmt*;
 
 class ParserError : public std::runtime_error {
 public:
-    ParserError(std::wstring const& msg)
+    ParserError(std::string const& msg)
         : std::runtime_error("")
         , m_msg(msg)
     {}
 
-    std::wstring msg() const { return m_msg; }
+    std::string msg() const { return m_msg; }
 
     virtual ~ParserError() = default;
 
 private:
-    std::wstring m_msg;
+    std::string m_msg;
 };
 
 class Parser final {
 public:
-    Parser(const std::vector<Token>& tokens)
-        : m_tokens(tokens)
+    // The nodes are allocated in 'arena', which has to outlive every use of
+    // the parsed program. Tokens are pulled from 'lexer' as the parser
+    // reaches them, only the current and the previous one are kept.
+    Parser(Lexer& lexer, Arena& arena)
+        : m_lexer(lexer)
+        , m_arena(arena)
+        , m_window()
         , m_current(0)
         , m_bHadError(false)
-    {}
+    {
+        m_window[m_current].emplace(m_lexer.next());
+    }
 
     ~Parser() = default;
 
-    std::vector<StmtPointer> parse();
+    ArenaList<StmtPointer> parse();
 
     inline bool error() const {
         return m_bHadError;
@@ -51,7 +61,7 @@ private:
 
     StmtPointer classDeclaration();
 
-    StmtPointer function(const std::wstring& kind);
+    StmtPointer function(const std::string& kind);
 
     StmtPointer letDeclaration();
 
@@ -102,21 +112,18 @@ private:
     // Helper functions
     bool check(TokenType type);
 
-    Token advance();
+    // Moves to the next token, the current one becomes previous(). A
+    // reference to previous() does not survive it.
+    const Token& advance();
 
-    ParserError error(Token token, std::wstring msg);
+    ParserError error(const Token& token, std::string msg);
 
     template <typename ...Op>
     bool match(Op ...ops)
     {
-        std::vector<TokenType> tokens;
-        (tokens.push_back(ops), ...);
-
-        for (auto& token : tokens) {
-            if (check(token)) {
-                advance();
-                return true;
-            }
+        if ((check(ops) || ...)) {
+            advance();
+            return true;
         }
 
         return false;
@@ -126,22 +133,26 @@ private:
         return peek().m_type == END_OF_FILE;
     }
 
-    inline Token peek() const {
-        return m_tokens.at(m_current);
+    inline const Token& peek() const {
+        return *m_window[m_current];
     }
 
-    inline Token previous() {
-        return m_tokens.at(m_current - 1);
+    inline const Token& previous() const {
+        return *m_window[m_current ^ 1];
     }
 
-    Token consume(TokenType type, std::wstring msg);
+    const Token& consume(TokenType type, std::string msg);
 
     void synchronize();
 
-    void reportError(Token token, std::wstring msg);
+    void reportError(const Token& token, std::string msg);
 
 private:
-    const std::vector<Token>& m_tokens;
+    Lexer& m_lexer;
+    Arena& m_arena;
+    // The current token and the previous one, 'm_current' is the slot of
+    // the current one
+    std::optional<Token> m_window[2];
     size_t m_current;
     bool m_bHadError;
 };
@@ -0,0 +1,43 @@
+#ifndef NEX_RESOLUTION_HPP
+#define NEX_RESOLUTION_HPP
+
+#include <cstdint>
+
+namespace nex {
+
+// Where the Resolver found the variable a node refers to, or where the
+// variable a declaration introduces is stored. Each call runs in a frame of
+// contiguous slots on the interpreter's value stack, a function's locals
+// are slots of its frame, numbered in declaration order with the slots of
+// ended blocks reused. Only the locals a nested function captures are
+// boxed into a Cell, the closure shares the Cell instead of the frame.
+struct Resolution {
+    enum Kind : uint8_t {
+        // Not declared in any scope, 'slot' is the index given by
+        // GlobalTable::indexOf
+        GLOBAL,
+        // Slot of the current frame
+        LOCAL,
+        // Slot of the current frame holding the Cell of a captured local
+        CELL,
+        // Index in the cells the running closure captured
+        UPVALUE,
+    };
+
+    Kind kind = GLOBAL;
+    uint32_t slot = 0;
+
+    inline bool isGlobal() const { return kind == GLOBAL; }
+};
+
+// Variable a function captures when it is declared: the Cell in slot
+// 'index' of the declaring frame, or else the one at 'index' in the cells
+// the declaring function captured itself
+struct Capture {
+    bool bLocal = false;
+    uint32_t index = 0;
+};
+
+}
+
+#endif
@@ -1,35 +1,39 @@
 #include "nex_resolver.hpp"
 #include "nex_diag.hpp"
+#include "nex_globals.hpp"
 
 namespace nex {
 
-Resolver::Resolver(std::shared_ptr<Interpreter> pInterp)
-    : m_bHadError(false)
-    , m_pInterp(pInterp)
+static const Symbol s_this = SymbolTable::intern("this");
+static const Symbol s_super = SymbolTable::intern("super");
+
+Resolver::Resolver(Arena& arena)
+    : m_arena(arena)
+    , m_bHadError(false)
     , m_scopes()
+    , m_functions(1)
     , m_currentFunctionType(FNONE)
     , m_currentClassType(CNONE)
 {}
 
-std::any Resolver::visitBlockStmt(stmt::Block* stmt)
+void Resolver::visitBlockStmt(stmt::Block* stmt)
 {
     beginScope();
     resolve(stmt->m_statements);
     endScope();
-    return nullptr;
 }
 
-std::any Resolver::visitClassStmt(stmt::Class* stmt)
+void Resolver::visitClassStmt(stmt::Class* stmt)
 {
     ClassType enclosingClass = m_currentClassType;
     m_currentClassType = CLASS;
 
-    declare(stmt->m_name);
+    declare(stmt->m_name, &stmt->m_resolution);
     define(stmt->m_name);
 
     if (stmt->m_superclass &&
-        stmt->m_superclass->m_name.m_lexeme == stmt->m_name.m_lexeme) {
-        ::nex::error(stmt->m_superclass->m_name.m_line, L"A class cannot inherit from itself");
+        stmt->m_superclass->m_name.m_symbol == stmt->m_name.m_symbol) {
+        ::nex::error(stmt->m_superclass->m_name.m_line, "A class cannot inherit from itself");
         m_bHadError = true;
     }
 
@@ -38,118 +42,115 @@ std::any Resolver::visitClassStmt(stmt::Class* stmt)
         resolve(stmt->m_superclass);
     }
 
+    // 'super' is a hidden local of the scope declaring the class, methods
+    // capture it like any other variable
     if (stmt->m_superclass) {
         beginScope();
-        (*m_scopes.back())[L"super"] = true;
+        declare(s_super, true, &stmt->m_superResolution);
     }
 
+    // Field initializers run in a frame of their own, with the new instance
+    // in its first slot
+    m_functions.emplace_back();
     beginScope();
-    (*m_scopes.back())[L"this"] = true;
-
+    declare(s_this, true, nullptr);
     for (auto field : stmt->m_fields) {
         if (field->m_init != nullptr) {
             resolve(field->m_init);
         }
     }
+    endScope();
+    stmt->m_fieldCaptures = m_arena.list(m_functions.back().captures);
+    m_functions.pop_back();
 
     for (auto method : stmt->m_methods) {
         auto funcType = METHOD;
-        if (method->m_name.m_lexeme == L"init") {
+        if (method->m_name.lexeme() == "init") {
             funcType = INITIALIZER;
         }
-        resolveFunction(method.get(), funcType);
+        resolveFunction(method, funcType);
     }
 
-    endScope();
-
     if (stmt->m_superclass) {
         endScope();
     }
 
     m_currentClassType = enclosingClass;
-    return nullptr;
 }
 
-std::any Resolver::visitExpressionStmt(stmt::Expression* stmt)
+void Resolver::visitExpressionStmt(stmt::Expression* stmt)
 {
     resolve(stmt->m_e);
-    return nullptr;
 }
 
-std::any Resolver::visitFunctionStmt(stmt::Function* stmt)
+void Resolver::visitFunctionStmt(stmt::Function* stmt)
 {
-    declare(stmt->m_name);
+    declare(stmt->m_name, &stmt->m_resolution);
     define(stmt->m_name);
 
     resolveFunction(stmt, FUNCTION);
-    return nullptr;
 }
 
-std::any Resolver::visitIfStmt(stmt::If* stmt)
+void Resolver::visitIfStmt(stmt::If* stmt)
 {
     resolve(stmt->m_cond);
     resolve(stmt->m_thenBranch);
     if (stmt->m_elseBranch) {
         resolve(stmt->m_elseBranch);
     }
-    return nullptr;
 }
 
-std::any Resolver::visitPrintStmt(stmt::Print* stmt)
+void Resolver::visitPrintStmt(stmt::Print* stmt)
 {
     resolve(stmt->m_e);
-    return nullptr;
 }
 
-std::any Resolver::visitReturnStmt(stmt::Return* stmt)
+void Resolver::visitReturnStmt(stmt::Return* stmt)
 {
     if (m_currentFunctionType == FNONE) {
-        ::nex::error(stmt->m_keyword.m_line, L"Illegal return statement");
+        ::nex::error(stmt->m_keyword.m_line, "Illegal return statement");
         m_bHadError = true;
     }
 
     if (stmt->m_value) {
         if (m_currentFunctionType == INITIALIZER) {
-            ::nex::error(stmt->m_keyword.m_line, L"Cannot return a value from an initializer");
+            ::nex::error(stmt->m_keyword.m_line, "Cannot return a value from an initializer");
             m_bHadError = true;
         }
         resolve(stmt->m_value);
     }
-    return nullptr;
 }
 
-std::any Resolver::visitLetStmt(stmt::Let* stmt)
+void Resolver::visitLetStmt(stmt::Let* stmt)
 {
-    declare(stmt->m_name);
+    declare(stmt->m_name, &stmt->m_resolution);
     if (stmt->m_init != nullptr) {
         resolve(stmt->m_init);
     }
     define(stmt->m_name);
-    return nullptr;
 }
 
-std::any Resolver::visitWhileStmt(stmt::While* stmt)
+void Resolver::visitWhileStmt(stmt::While* stmt)
 {
     resolve(stmt->m_cond);
     resolve(stmt->m_body);
-    return nullptr;
 }
 
-std::any Resolver::visitAssignExpr(expr::Assign* expr)
+Value Resolver::visitAssignExpr(expr::Assign* expr)
 {
     resolve(expr->m_value);
-    resolveLocal(expr, expr->m_name);
+    resolveLocal(expr->m_resolution, expr->m_name);
     return nullptr;
 }
 
-std::any Resolver::visitBinaryExpr(expr::Binary* expr)
+Value Resolver::visitBinaryExpr(expr::Binary* expr)
 {
     resolve(expr->m_left);
     resolve(expr->m_right);
     return nullptr;
 }
 
-std::any Resolver::visitCallExpr(expr::Call* expr)
+Value Resolver::visitCallExpr(expr::Call* expr)
 {
     resolve(expr->m_callee);
 
@@ -160,111 +161,122 @@ std::any Resolver::visitCallExpr(expr::Call* expr)
     return nullptr;
 }
 
-std::any Resolver::visitGetExpr(expr::Get* expr)
+Value Resolver::visitGetExpr(expr::Get* expr)
 {
     resolve(expr->m_object);
     return nullptr;
 }
 
-std::any Resolver::visitSetExpr(expr::Set* expr)
+Value Resolver::visitSetExpr(expr::Set* expr)
 {
     resolve(expr->m_value);
     resolve(expr->m_object);
     return nullptr;
 }
 
-std::any Resolver::visitSuperExpr(expr::Super* expr)
+Value Resolver::visitSuperExpr(expr::Super* expr)
 {
     if (m_currentClassType == CNONE) {
-        ::nex::error(expr->m_keyword.m_line, L"Cannot use 'super' outside of a class");
+        ::nex::error(expr->m_keyword.m_line, "Cannot use 'super' outside of a class");
         m_bHadError = true;
     }
     else if (m_currentClassType != SUBCLASS) {
-        ::nex::error(expr->m_keyword.m_line, L"Cannot use 'super' in a class with not superclass.");
+        ::nex::error(expr->m_keyword.m_line, "Cannot use 'super' in a class with not superclass.");
         m_bHadError = true;
     }
 
-    resolveLocal(expr, expr->m_keyword);
+    resolveLocal(expr->m_resolution, expr->m_keyword);
+    resolveLocal(expr->m_thisResolution, SlimToken(THIS, s_this, expr->m_keyword.m_line));
     return nullptr;
 };
 
-std::any Resolver::visitThisExpr(expr::This* expr)
+Value Resolver::visitThisExpr(expr::This* expr)
 {
     if (m_currentClassType == CNONE) {
-        ::nex::error(expr->m_keyword.m_line, L"Cannot use 'this' outside of a class");
+        ::nex::error(expr->m_keyword.m_line, "Cannot use 'this' outside of a class");
         m_bHadError = true;
         return nullptr;
     }
 
-    resolveLocal(expr, expr->m_keyword);
+    resolveLocal(expr->m_resolution, expr->m_keyword);
     return nullptr;
 }
 
-std::any Resolver::visitGroupingExpr(expr::Grouping* expr)
+Value Resolver::visitGroupingExpr(expr::Grouping* expr)
 {
     resolve(expr->m_expression);
     return nullptr;
 }
 
-std::any Resolver::visitLiteralExpr(expr::Literal* expr)
+Value Resolver::visitLiteralExpr(expr::Literal* expr)
 {
     (void) expr;
     return nullptr;
 }
 
-std::any Resolver::visitLogicalExpr(expr::Logical* expr)
+Value Resolver::visitLogicalExpr(expr::Logical* expr)
 {
     resolve(expr->m_left);
     resolve(expr->m_right);
     return nullptr;
 }
 
-std::any Resolver::visitUnaryExpr(expr::Unary* expr)
+Value Resolver::visitUnaryExpr(expr::Unary* expr)
 {
     resolve(expr->m_right);
     return nullptr;
 }
 
-std::any Resolver::visitCommaExpr(expr::Comma* expr)
+Value Resolver::visitCommaExpr(expr::Comma* expr)
 {
-    (void) expr;
+    for (auto e : expr->m_exprs) {
+        resolve(e);
+    }
+    resolve(expr->m_last);
     return nullptr;
 }
 
-std::any Resolver::visitVariableExpr(expr::Variable* expr)
+Value Resolver::visitVariableExpr(expr::Variable* expr)
 {
     if (!m_scopes.empty() &&
-        m_scopes.back()->count(expr->m_name.m_lexeme) != 0 &&
-        m_scopes.back()->at(expr->m_name.m_lexeme) == false) {
-        ::nex::error(expr->m_name.m_line, L"Cannot read local variable in its own initializer");
+        m_scopes.back()->variables.count(expr->m_name.m_symbol) != 0 &&
+        !m_scopes.back()->variables.at(expr->m_name.m_symbol).bDefined) {
+        ::nex::error(expr->m_name.m_line, "Cannot read local variable in its own initializer");
         m_bHadError = true;
     }
 
-    resolveLocal(expr, expr->m_name);
+    resolveLocal(expr->m_resolution, expr->m_name);
     return nullptr;
 }
 
-std::any Resolver::visitInputExpr(expr::Input* expr)
+Value Resolver::visitInputExpr(expr::Input* expr)
 {
     (void) expr;
     return nullptr;
 }
 
-void Resolver::resolve(const std::vector<std::shared_ptr<stmt::Stmt>> statements)
+void Resolver::resolve(ArenaList<stmt::Stmt*> statements)
 {
     for (auto pStmt : statements) {
         resolve(pStmt);
     }
 }
 
-void Resolver::resolve(std::shared_ptr<stmt::Stmt> statement)
+void Resolver::resolve(stmt::Stmt* statement)
 {
     statement->accept(this);
 }
 
 void Resolver::beginScope()
 {
-    m_scopes.push_back(std::make_shared<std::unordered_map<std::wstring, bool>>());
+    // Blocks take the slots after the ones of the enclosing scope, in the
+    // same frame
+    auto scope = std::make_shared<Scope>();
+    scope->function = m_functions.size() - 1;
+    if (!m_scopes.empty() && m_scopes.back()->function == scope->function) {
+        scope->nextSlot = m_scopes.back()->nextSlot;
+    }
+    m_scopes.push_back(scope);
 }
 
 void Resolver::endScope()
@@ -272,42 +284,118 @@ void Resolver::endScope()
     m_scopes.pop_back();
 }
 
-void Resolver::resolve(std::shared_ptr<expr::Expr> expr)
+void Resolver::resolve(expr::Expr* expr)
 {
     expr->accept(this);
 }
 
-void Resolver::define(Token const& name)
+void Resolver::define(SlimToken const& name)
 {
     if (m_scopes.empty()) {
         return;
     }
 
-    (*m_scopes.back())[name.m_lexeme] = true;
+    auto& variables = m_scopes.back()->variables;
+    auto it = variables.find(name.m_symbol);
+    if (it != variables.end()) {
+        it->second.bDefined = true;
+    }
 }
 
-void Resolver::declare(Token const& name)
+void Resolver::declare(SlimToken const& name, Resolution* pResolution)
 {
     if (m_scopes.empty()) {
+        pResolution->kind = Resolution::GLOBAL;
+        pResolution->slot = GlobalTable::indexOf(name.m_symbol);
         return;
     }
 
-    auto scope = m_scopes.back();
-    if (scope->count(name.m_lexeme)) {
-        ::nex::error(name.m_line, L"Identifier '" + name.m_lexeme + L"' has already been declared");
+    if (m_scopes.back()->variables.count(name.m_symbol)) {
+        ::nex::error(name.m_line, "Identifier '" + name.lexeme() + "' has already been declared");
         m_bHadError = true;
+        return;
     }
-    (*scope)[name.m_lexeme] = false;
+    declare(name.m_symbol, false, pResolution);
 }
 
-void Resolver::resolveLocal(expr::Expr* expr, Token const& name)
+void Resolver::declare(Symbol name, bool bDefined, Resolution* pResolution)
 {
+    // Slots are handed out in the order the interpreter defines the
+    // variables at runtime, which is their order in the source
+    auto scope = m_scopes.back();
+    Variable variable{ scope->nextSlot++, bDefined, false, pResolution == nullptr, {} };
+    if (pResolution) {
+        pResolution->kind = Resolution::LOCAL;
+        pResolution->slot = variable.slot;
+        variable.uses.push_back(pResolution);
+    }
+    scope->variables.emplace(name, std::move(variable));
+}
+
+void Resolver::resolveLocal(Resolution& resolution, SlimToken const& name)
+{
+    auto current = m_functions.size() - 1;
     for (int idx = m_scopes.size() - 1; idx >= 0; idx--) {
-        if (m_scopes[idx]->count(name.m_lexeme)) {
-            m_pInterp->resolve(expr, m_scopes.size() - 1 - idx);
+        auto it = m_scopes[idx]->variables.find(name.m_symbol);
+        if (it == m_scopes[idx]->variables.end()) {
+            continue;
+        }
+
+        auto& variable = it->second;
+        auto function = m_scopes[idx]->function;
+        if (function == current) {
+            resolution.kind = variable.bCaptured ? Resolution::CELL : Resolution::LOCAL;
+            resolution.slot = variable.slot;
+            if (!variable.bCaptured) {
+                variable.uses.push_back(&resolution);
+            }
             return;
         }
+
+        // Declared by an enclosing function: every function in between
+        // captures it, each from the one around it
+        capture(variable);
+        auto index = variable.slot;
+        auto bLocal = true;
+        for (auto fn = function + 1; fn <= current; fn++) {
+            index = addCapture(m_functions[fn], bLocal, index);
+            bLocal = false;
+        }
+
+        resolution.kind = Resolution::UPVALUE;
+        resolution.slot = index;
+        return;
+    }
+
+    // Not found in any scope, the name is a global
+    resolution.kind = Resolution::GLOBAL;
+    resolution.slot = GlobalTable::indexOf(name.m_symbol);
+}
+
+uint32_t Resolver::addCapture(Function& function, bool bLocal, uint32_t index)
+{
+    auto& captures = function.captures;
+    for (size_t idx = 0; idx < captures.size(); idx++) {
+        if (captures[idx].bLocal == bLocal && captures[idx].index == index) {
+            return static_cast<uint32_t>(idx);
+        }
     }
+
+    captures.push_back(Capture{ bLocal, index });
+    return static_cast<uint32_t>(captures.size() - 1);
+}
+
+void Resolver::capture(Variable& variable)
+{
+    if (variable.bCaptured) {
+        return;
+    }
+
+    variable.bCaptured = true;
+    for (auto pResolution : variable.uses) {
+        pResolution->kind = Resolution::CELL;
+    }
+    variable.uses.clear();
 }
 
 void Resolver::resolveFunction(stmt::Function* func, FunctionType funcType)
@@ -315,13 +403,36 @@ void Resolver::resolveFunction(stmt::Function* func, FunctionType funcType)
     auto enclosingFunction = m_currentFunctionType;
     m_currentFunctionType = funcType;
 
+    m_functions.emplace_back();
     beginScope();
+
+    // Methods find 'this' in the first slot of their frame
+    if (funcType == METHOD || funcType == INITIALIZER) {
+        declare(s_this, true, nullptr);
+    }
+
     for (auto param : func->m_params) {
-        declare(param);
-        define(param);
+        if (m_scopes.back()->variables.count(param.m_symbol)) {
+            ::nex::error(param.m_line, "Identifier '" + param.lexeme() + "' has already been declared");
+            m_bHadError = true;
+            continue;
+        }
+        declare(param.m_symbol, true, nullptr);
     }
     resolve(func->m_body);
+
+    std::vector<uint32_t> cells;
+    for (const auto& [name, variable] : m_scopes.back()->variables) {
+        (void) name;
+        if (variable.bParameter && variable.bCaptured) {
+            cells.push_back(variable.slot);
+        }
+    }
+    func->m_cells = m_arena.list(cells);
+    func->m_captures = m_arena.list(m_functions.back().captures);
+
     endScope();
+    m_functions.pop_back();
 
     m_currentFunctionType = enclosingFunction;
 }
@@ -2,7 +2,6 @@
 #define NEX_RESOLVER_HPP
 
 #include "nex_expr.hpp"
-#include "nex_interpreter.hpp"
 #include "nex_stmt.hpp"
 #include "nex_token.hpp"
 
@@ -14,36 +13,41 @@
 namespace nex
 {
 
+using namespace nex::ast;
+
 class Resolver final : public stmt::Visitor, public expr::Visitor
 {
 public:
-    Resolver(std::shared_ptr<Interpreter> pInterp);
+    // Every variable access and declaration is annotated with its
+    // Resolution, in the node. The capture lists of functions are allocated
+    // in 'arena', the one the program was parsed into.
+    explicit Resolver(Arena& arena);
     ~Resolver() = default;
 
-    std::any visitBlockStmt(stmt::Block* stmt) override;
-    std::any visitClassStmt(stmt::Class* stmt) override;
-    std::any visitExpressionStmt(stmt::Expression* stmt) override;
-    std::any visitFunctionStmt(stmt::Function* stmt) override;
-    std::any visitIfStmt(stmt::If* stmt) override;
-    std::any visitPrintStmt(stmt::Print* stmt) override;
-    std::any visitReturnStmt(stmt::Return* stmt) override;
-    std::any visitLetStmt(stmt::Let* stmt) override;
-    std::any visitWhileStmt(stmt::While* stmt) override;
-
-    std::any visitAssignExpr(expr::Assign* expr) override;
-    std::any visitBinaryExpr(expr::Binary* expr) override;
-    std::any visitCallExpr(expr::Call* expr) override;
-    std::any visitGetExpr(expr::Get* expr) override;
-    std::any visitSetExpr(expr::Set* expr) override;
-    std::any visitSuperExpr(expr::Super* expr) override;
-    std::any visitThisExpr(expr::This* expr) override;
-    std::any visitGroupingExpr(expr::Grouping* expr) override;
-    std::any visitLiteralExpr(expr::Literal* expr) override;
-    std::any visitLogicalExpr(expr::Logical* expr) override;
-    std::any visitUnaryExpr(expr::Unary* expr) override;
-    std::any visitCommaExpr(expr::Comma* expr) override;
-    std::any visitVariableExpr(expr::Variable* expr) override;
-    std::any visitInputExpr(expr::Input* expr) override;
+    void visitBlockStmt(stmt::Block* stmt) override;
+    void visitClassStmt(stmt::Class* stmt) override;
+    void visitExpressionStmt(stmt::Expression* stmt) override;
+    void visitFunctionStmt(stmt::Function* stmt) override;
+    void visitIfStmt(stmt::If* stmt) override;
+    void visitPrintStmt(stmt::Print* stmt) override;
+    void visitReturnStmt(stmt::Return* stmt) override;
+    void visitLetStmt(stmt::Let* stmt) override;
+    void visitWhileStmt(stmt::While* stmt) override;
+
+    Value visitAssignExpr(expr::Assign* expr) override;
+    Value visitBinaryExpr(expr::Binary* expr) override;
+    Value visitCallExpr(expr::Call* expr) override;
+    Value visitGetExpr(expr::Get* expr) override;
+    Value visitSetExpr(expr::Set* expr) override;
+    Value visitSuperExpr(expr::Super* expr) override;
+    Value visitThisExpr(expr::This* expr) override;
+    Value visitGroupingExpr(expr::Grouping* expr) override;
+    Value visitLiteralExpr(expr::Literal* expr) override;
+    Value visitLogicalExpr(expr::Logical* expr) override;
+    Value visitUnaryExpr(expr::Unary* expr) override;
+    Value visitCommaExpr(expr::Comma* expr) override;
+    Value visitVariableExpr(expr::Variable* expr) override;
+    Value visitInputExpr(expr::Input* expr) override;
 
 public:
     enum FunctionType {
@@ -59,20 +63,55 @@ public:
         SUBCLASS,
     };
 
-    void resolve(const std::vector<std::shared_ptr<stmt::Stmt>> statements);
-    void resolve(std::shared_ptr<stmt::Stmt> statement);
+    void resolve(ArenaList<stmt::Stmt*> statements);
+    void resolve(stmt::Stmt* statement);
     void beginScope();
     void endScope();
-    void resolve(std::shared_ptr<expr::Expr> expr);
-    void declare(Token const& name);
-    void define(Token const& name);
-    void resolveLocal(expr::Expr* expr, Token const& name);
+    void resolve(expr::Expr* expr);
+    // Declares 'name' in the innermost scope, a global outside of every
+    // scope. Where it ends up is written to 'pResolution'.
+    void declare(SlimToken const& name, Resolution* pResolution);
+    void declare(Symbol name, bool bDefined, Resolution* pResolution);
+    void define(SlimToken const& name);
+    void resolveLocal(Resolution& resolution, SlimToken const& name);
     void resolveFunction(stmt::Function* func, FunctionType funcType);
     inline bool error() const { return m_bHadError; }
 private:
+    struct Variable {
+        // Slot in the frame of the function declaring the variable
+        uint32_t slot;
+        bool bDefined;
+        // A nested function uses the variable, it lives in a Cell
+        bool bCaptured;
+        // Parameters (and 'this') are boxed when the frame is entered
+        bool bParameter;
+        // Accesses resolved before the variable was captured, they are
+        // turned into CELL accesses when it is
+        std::vector<Resolution*> uses;
+    };
+
+    struct Scope {
+        std::unordered_map<Symbol, Variable> variables;
+        // Slot of the next variable declared in the scope
+        uint32_t nextSlot = 0;
+        // Index in m_functions of the function the scope belongs to
+        size_t function = 0;
+    };
+
+    // A function being resolved, the top level code is the first one
+    struct Function {
+        std::vector<Capture> captures;
+    };
+
+    // Index of the capture of 'function' for the given variable, added
+    // to its captures if it is the first use
+    uint32_t addCapture(Function& function, bool bLocal, uint32_t index);
+    void capture(Variable& variable);
+
+    Arena& m_arena;
     bool m_bHadError;
-    std::shared_ptr<Interpreter> m_pInterp;
-    std::deque<std::shared_ptr<std::unordered_map<std::wstring, bool>>> m_scopes;
+    std::deque<std::shared_ptr<Scope>> m_scopes;
+    std::vector<Function> m_functions;
     FunctionType m_currentFunctionType;
     ClassType m_currentClassType;
 };
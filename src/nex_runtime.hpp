@@ -1,48 +1,128 @@
 #ifndef NEX_RUNTIME_HPP
 #define NEX_RUNTIME_HPP
 
-#include "nex_callable.hpp"
+#include "nex_native.hpp"
 
 #include <chrono>
-#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define NEX_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NEX_HAS_RDTSC 1
+#endif
 
 namespace nex::runtime {
 
-// Native function table (identifier and symbol)
+// Native function table (name and C++ function), both engines define each
+// entry as a global through makeNative
 #define NATIVE_FN_LIST \
-    EMIT_NATIVE_FN(Token(IDENTIFIER, L"clock", nullptr, 0), SystemClock())
+    EMIT_NATIVE_FN("clock", systemClock) \
+    EMIT_NATIVE_FN("clock_ns", clockNanos) \
+    EMIT_NATIVE_FN("clock_us", clockMicros) \
+    EMIT_NATIVE_FN("clock_cycles", clockCycles) \
+    EMIT_NATIVE_FN("sqrt", mathSqrt) \
+    EMIT_NATIVE_FN("pow", mathPow) \
+    EMIT_NATIVE_FN("floor", mathFloor) \
+    EMIT_NATIVE_FN("ceil", mathCeil) \
+    EMIT_NATIVE_FN("abs", mathAbs) \
+    EMIT_NATIVE_FN("min", mathMin) \
+    EMIT_NATIVE_FN("max", mathMax) \
+    EMIT_NATIVE_FN("sin", mathSin) \
+    EMIT_NATIVE_FN("cos", mathCos) \
+    EMIT_NATIVE_FN("log", mathLog) \
+    EMIT_NATIVE_FN("exp", mathExp) \
+    EMIT_NATIVE_FN("random", mathRandom) \
+    EMIT_NATIVE_FN("seed", mathSeed)
 
-class SystemClock : public NexCallable
+// Seconds since the epoch
+inline double systemClock()
 {
-public:
-    SystemClock() = default;
-    virtual ~SystemClock() = default;
-
-    inline
-    std::any call(Interpreter* interp, std::vector<std::any> arguments) override
-    {
-        (void) interp;
-        (void) arguments;
-
-        auto now = std::chrono::system_clock::now();
-        auto t = std::chrono::system_clock::to_time_t(now);
-        return static_cast<double>(t);
-    }
-
-    inline size_t arity() const override
-    {
-        return 0;
-    }
-
-    inline std::wstring to_string() const override
-    {
-        return L"<native func 'clock'>";
-    }
-
-    inline std::wstring name() const override {
-        return L"clock";
-    }
-};
-
-}
-#endif
\ No newline at end of file
+    auto now = std::chrono::system_clock::now();
+    auto t = std::chrono::system_clock::to_time_t(now);
+    return static_cast<double>(t);
+}
+
+// Monotonic clocks for timing, only the difference of two readings is
+// meaningful. A double holds the nanoseconds exactly for over 100 days.
+
+inline double clockNanos()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+inline double clockMicros()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+}
+
+// Raw CPU cycle counter where there is one, the cheapest reading but not
+// comparable across cores or frequency changes. Else the nanosecond clock.
+inline double clockCycles()
+{
+#if defined(NEX_HAS_RDTSC)
+    return static_cast<double>(__rdtsc());
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return static_cast<double>(ticks);
+#else
+    return clockNanos();
+#endif
+}
+
+// Math, the <cmath> functions are overloaded so each one gets a wrapper to
+// bind
+
+inline double mathSqrt(double x) { return std::sqrt(x); }
+inline double mathPow(double x, double y) { return std::pow(x, y); }
+inline double mathFloor(double x) { return std::floor(x); }
+inline double mathCeil(double x) { return std::ceil(x); }
+inline double mathAbs(double x) { return std::fabs(x); }
+inline double mathMin(double x, double y) { return y < x ? y : x; }
+inline double mathMax(double x, double y) { return x < y ? y : x; }
+inline double mathSin(double x) { return std::sin(x); }
+inline double mathCos(double x) { return std::cos(x); }
+inline double mathLog(double x) { return std::log(x); }
+inline double mathExp(double x) { return std::exp(x); }
+
+// State of the xorshift64* generator behind 'random', a fixed seed until
+// the script calls 'seed' so runs are reproducible
+inline uint64_t& randomState()
+{
+    static uint64_t s_state = 0x9E3779B97F4A7C15ull;
+    return s_state;
+}
+
+// Uniform in [0, 1)
+inline double mathRandom()
+{
+    auto& x = randomState();
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    return static_cast<double>((x * 0x2545F4914F6CDD1Dull) >> 11) * 0x1.0p-53;
+}
+
+inline void mathSeed(double seed)
+{
+    // One splitmix64 step spreads the seed's bits over the whole state,
+    // which must not be zero. Hashing the bits and not a conversion to an
+    // integer keeps NaN, infinities and huge seeds defined.
+    uint64_t z = 0;
+    std::memcpy(&z, &seed, sizeof(z));
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    randomState() = z ? z : 0x9E3779B97F4A7C15ull;
+}
+
+}
+#endif
@@ -10,7 +10,7 @@ namespace nex {
 class NexRunTimeError : public std::runtime_error
 {
 public:
-    NexRunTimeError(const Token& op, const std::wstring& s)
+    NexRunTimeError(const SlimToken& op, const std::string& s)
         : std::runtime_error("")
         , m_op(op)
         , m_str(s)
@@ -18,13 +18,13 @@ public:
 
     virtual ~NexRunTimeError() = default;
 
-    inline std::wstring msg() const
+    inline std::string msg() const
     {
         return m_str;
     }
 
-    const Token& m_op;
-    std::wstring m_str;
+    const SlimToken m_op;
+    std::string m_str;
 };
 
 }
@@ -0,0 +1,52 @@
+#include "nex_source.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nex {
+
+SourceFile::SourceFile(const char* path)
+    : m_pMapping(nullptr)
+    , m_size(0)
+    , m_buffer()
+    , m_bOpen(false)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        auto size = static_cast<size_t>(info.st_size);
+        void* pMapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pMapping != MAP_FAILED) {
+            // The lexer makes a single pass from the start
+            ::madvise(pMapping, size, MADV_SEQUENTIAL);
+            m_pMapping = static_cast<const char*>(pMapping);
+            m_size = size;
+            m_bOpen = true;
+            ::close(fd);
+            return;
+        }
+    }
+
+    char chunk[64 * 1024];
+    ssize_t count;
+    while ((count = ::read(fd, chunk, sizeof(chunk))) > 0) {
+        m_buffer.append(chunk, static_cast<size_t>(count));
+    }
+    m_bOpen = count == 0;
+    ::close(fd);
+}
+
+SourceFile::~SourceFile()
+{
+    if (m_pMapping) {
+        ::munmap(const_cast<char*>(m_pMapping), m_size);
+    }
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef NEX_SOURCE_HPP
+#define NEX_SOURCE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace nex {
+
+// The text of a source file. A regular file is mapped into memory and read
+// in place, the Lexer and its tokens view the mapping instead of a copy.
+// Anything else, a pipe for instance, is read into a buffer.
+class SourceFile final
+{
+public:
+    explicit SourceFile(const char* path);
+    ~SourceFile();
+
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+
+    inline bool isOpen() const { return m_bOpen; }
+
+    inline std::string_view text() const
+    {
+        return m_pMapping ? std::string_view(m_pMapping, m_size) : m_buffer;
+    }
+
+private:
+    const char* m_pMapping;
+    size_t m_size;
+    std::string m_buffer;
+    bool m_bOpen;
+};
+
+}
+
+#endif
@@ -1,10 +1,10 @@
 #ifndef NEX_STMT_HPP_
 #define NEX_STMT_HPP_
 
+#include "nex_arena.hpp"
 #include "nex_token.hpp"
 #include "nex_expr.hpp"
-#include <memory>
-#include <vector>
+#include "nex_resolution.hpp"
 
 namespace nex::ast::stmt {
 struct Block;
@@ -19,201 +19,197 @@ struct While;
 
 class Visitor {
 public:
-    virtual std::any visitBlockStmt(Block* stmt) = 0;
-    virtual std::any visitClassStmt(Class* stmt) = 0;
-    virtual std::any visitExpressionStmt(Expression* stmt) = 0;
-    virtual std::any visitFunctionStmt(Function* stmt) = 0;
-    virtual std::any visitIfStmt(If* stmt) = 0;
-    virtual std::any visitPrintStmt(Print* stmt) = 0;
-    virtual std::any visitReturnStmt(Return* stmt) = 0;
-    virtual std::any visitLetStmt(Let* stmt) = 0;
-    virtual std::any visitWhileStmt(While* stmt) = 0;
+    virtual void visitBlockStmt(Block* stmt) = 0;
+    virtual void visitClassStmt(Class* stmt) = 0;
+    virtual void visitExpressionStmt(Expression* stmt) = 0;
+    virtual void visitFunctionStmt(Function* stmt) = 0;
+    virtual void visitIfStmt(If* stmt) = 0;
+    virtual void visitPrintStmt(Print* stmt) = 0;
+    virtual void visitReturnStmt(Return* stmt) = 0;
+    virtual void visitLetStmt(Let* stmt) = 0;
+    virtual void visitWhileStmt(While* stmt) = 0;
 };
 
 struct Stmt {
-    virtual std::any accept(Visitor* visitor) = 0;
+    virtual void accept(Visitor* visitor) = 0;
 };
 
 struct Block : public Stmt {
-    Block(std::vector<std::shared_ptr<Stmt>> statements) :
+    Block(ArenaList<Stmt*> statements) :
         m_statements(statements)
     {}
 
-    virtual ~Block() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitBlockStmt(this);
     }
 
-    const std::vector<std::shared_ptr<Stmt>> m_statements;
+    ArenaList<Stmt*> m_statements;
 };
 
-inline std::shared_ptr<Stmt> make_block(std::vector<std::shared_ptr<Stmt>> statements) {
-    return std::make_shared<Block>(statements);
+inline Block* make_block(Arena& arena, ArenaList<Stmt*> statements) {
+    return arena.make<Block>(statements);
 }
 
 struct Class : public Stmt {
-    Class(Token name, std::shared_ptr<expr::Variable> superclass, std::vector<std::shared_ptr<Function>> methods, std::vector<std::shared_ptr<Let>> fields) :
+    Class(SlimToken name, expr::Variable* superclass, ArenaList<Function*> methods, ArenaList<Let*> fields) :
         m_name(name),
         m_superclass(superclass),
         m_methods(methods),
-        m_fields(fields)
+        m_fields(fields),
+        m_resolution(),
+        m_superResolution(),
+        m_fieldCaptures()
     {}
 
-    virtual ~Class() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitClassStmt(this);
     }
 
-    const Token m_name;
-    const std::shared_ptr<expr::Variable> m_superclass;
-    const std::vector<std::shared_ptr<Function>> m_methods;
-    const std::vector<std::shared_ptr<Let>> m_fields;
+    SlimToken const m_name;
+    expr::Variable* m_superclass;
+    ArenaList<Function*> m_methods;
+    ArenaList<Let*> m_fields;
+    Resolution m_resolution;
+    Resolution m_superResolution;
+    ArenaList<Capture> m_fieldCaptures;
 };
 
-inline std::shared_ptr<Stmt> make_class(Token name, std::shared_ptr<expr::Variable> superclass, std::vector<std::shared_ptr<Function>> methods, std::vector<std::shared_ptr<Let>> fields) {
-    return std::make_shared<Class>(name, superclass, methods, fields);
+inline Class* make_class(Arena& arena, SlimToken name, expr::Variable* superclass, ArenaList<Function*> methods, ArenaList<Let*> fields) {
+    return arena.make<Class>(name, superclass, methods, fields);
 }
 
 struct Expression : public Stmt {
-    Expression(std::shared_ptr<expr::Expr> e) :
+    Expression(expr::Expr* e) :
         m_e(e)
     {}
 
-    virtual ~Expression() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitExpressionStmt(this);
     }
 
-    const std::shared_ptr<expr::Expr> m_e;
+    expr::Expr* m_e;
 };
 
-inline std::shared_ptr<Stmt> make_expression(std::shared_ptr<expr::Expr> e) {
-    return std::make_shared<Expression>(e);
+inline Expression* make_expression(Arena& arena, expr::Expr* e) {
+    return arena.make<Expression>(e);
 }
 
 struct Function : public Stmt {
-    Function(Token name, std::vector<Token> params, std::vector<std::shared_ptr<Stmt>> body) :
+    Function(SlimToken name, ArenaList<SlimToken> params, ArenaList<Stmt*> body) :
         m_name(name),
         m_params(params),
-        m_body(body)
+        m_body(body),
+        m_resolution(),
+        m_captures(),
+        m_cells()
     {}
 
-    virtual ~Function() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitFunctionStmt(this);
     }
 
-    const Token m_name;
-    const std::vector<Token> m_params;
-    const std::vector<std::shared_ptr<Stmt>> m_body;
+    SlimToken const m_name;
+    ArenaList<SlimToken> m_params;
+    ArenaList<Stmt*> m_body;
+    Resolution m_resolution;
+    ArenaList<Capture> m_captures;
+    ArenaList<uint32_t> m_cells;
 };
 
-inline std::shared_ptr<Stmt> make_function(Token name, std::vector<Token> params, std::vector<std::shared_ptr<Stmt>> body) {
-    return std::make_shared<Function>(name, params, body);
+inline Function* make_function(Arena& arena, SlimToken name, ArenaList<SlimToken> params, ArenaList<Stmt*> body) {
+    return arena.make<Function>(name, params, body);
 }
 
 struct If : public Stmt {
-    If(std::shared_ptr<expr::Expr> cond, std::shared_ptr<Stmt> thenBranch, std::shared_ptr<Stmt> elseBranch) :
+    If(expr::Expr* cond, Stmt* thenBranch, Stmt* elseBranch) :
         m_cond(cond),
         m_thenBranch(thenBranch),
         m_elseBranch(elseBranch)
     {}
 
-    virtual ~If() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitIfStmt(this);
     }
 
-    const std::shared_ptr<expr::Expr> m_cond;
-    const std::shared_ptr<Stmt> m_thenBranch;
-    const std::shared_ptr<Stmt> m_elseBranch;
+    expr::Expr* m_cond;
+    Stmt* m_thenBranch;
+    Stmt* m_elseBranch;
 };
 
-inline std::shared_ptr<Stmt> make_if(std::shared_ptr<expr::Expr> cond, std::shared_ptr<Stmt> thenBranch, std::shared_ptr<Stmt> elseBranch) {
-    return std::make_shared<If>(cond, thenBranch, elseBranch);
+inline If* make_if(Arena& arena, expr::Expr* cond, Stmt* thenBranch, Stmt* elseBranch) {
+    return arena.make<If>(cond, thenBranch, elseBranch);
 }
 
 struct Print : public Stmt {
-    Print(std::shared_ptr<expr::Expr> e) :
+    Print(expr::Expr* e) :
         m_e(e)
     {}
 
-    virtual ~Print() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitPrintStmt(this);
     }
 
-    const std::shared_ptr<expr::Expr> m_e;
+    expr::Expr* m_e;
 };
 
-inline std::shared_ptr<Stmt> make_print(std::shared_ptr<expr::Expr> e) {
-    return std::make_shared<Print>(e);
+inline Print* make_print(Arena& arena, expr::Expr* e) {
+    return arena.make<Print>(e);
 }
 
 struct Return : public Stmt {
-    Return(Token keyword, std::shared_ptr<expr::Expr> value) :
+    Return(SlimToken keyword, expr::Expr* value) :
         m_keyword(keyword),
         m_value(value)
     {}
 
-    virtual ~Return() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitReturnStmt(this);
     }
 
-    const Token m_keyword;
-    const std::shared_ptr<expr::Expr> m_value;
+    SlimToken const m_keyword;
+    expr::Expr* m_value;
 };
 
-inline std::shared_ptr<Stmt> make_return(Token keyword, std::shared_ptr<expr::Expr> value) {
-    return std::make_shared<Return>(keyword, value);
+inline Return* make_return(Arena& arena, SlimToken keyword, expr::Expr* value) {
+    return arena.make<Return>(keyword, value);
 }
 
 struct Let : public Stmt {
-    Let(Token name, std::shared_ptr<expr::Expr> init) :
+    Let(SlimToken name, expr::Expr* init) :
         m_name(name),
-        m_init(init)
+        m_init(init),
+        m_resolution()
     {}
 
-    virtual ~Let() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitLetStmt(this);
     }
 
-    const Token m_name;
-    const std::shared_ptr<expr::Expr> m_init;
+    SlimToken const m_name;
+    expr::Expr* m_init;
+    Resolution m_resolution;
 };
 
-inline std::shared_ptr<Stmt> make_let(Token name, std::shared_ptr<expr::Expr> init) {
-    return std::make_shared<Let>(name, init);
+inline Let* make_let(Arena& arena, SlimToken name, expr::Expr* init) {
+    return arena.make<Let>(name, init);
 }
 
 struct While : public Stmt {
-    While(std::shared_ptr<expr::Expr> cond, std::shared_ptr<Stmt> body) :
+    While(expr::Expr* cond, Stmt* body) :
         m_cond(cond),
         m_body(body)
     {}
 
-    virtual ~While() = default;
-
-    std::any accept(Visitor* visitor) {
+    void accept(Visitor* visitor) {
         return visitor->visitWhileStmt(this);
     }
 
-    const std::shared_ptr<expr::Expr> m_cond;
-    const std::shared_ptr<Stmt> m_body;
+    expr::Expr* m_cond;
+    Stmt* m_body;
 };
 
-inline std::shared_ptr<Stmt> make_while(std::shared_ptr<expr::Expr> cond, std::shared_ptr<Stmt> body) {
-    return std::make_shared<While>(cond, body);
+inline While* make_while(Arena& arena, expr::Expr* cond, Stmt* body) {
+    return arena.make<While>(cond, body);
 }
 
 }
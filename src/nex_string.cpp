@@ -0,0 +1,79 @@
+#include "nex_string.hpp"
+
+#include <vector>
+
+namespace nex {
+
+NexString::NexString(Ref<NexString> left, Ref<NexString> right)
+    : m_str()
+    , m_left(std::move(left))
+    , m_right(std::move(right))
+    , m_size(m_left->m_size + m_right->m_size)
+    , m_bInterned(false)
+{}
+
+NexString::~NexString()
+{
+    if (!m_left) {
+        return;
+    }
+
+    // A rope built in a loop is a chain as long as the loop, the nodes only
+    // this one holds are released here instead of recursively
+    std::vector<Ref<NexString>> pending;
+    pending.push_back(std::move(m_left));
+    pending.push_back(std::move(m_right));
+    while (!pending.empty()) {
+        auto node = std::move(pending.back());
+        pending.pop_back();
+        if (node->refCount() == 1 && node->m_left) {
+            pending.push_back(std::move(node->m_left));
+            pending.push_back(std::move(node->m_right));
+        }
+    }
+}
+
+Ref<NexString> NexString::concat(NexString* pLeft, NexString* pRight)
+{
+    if (pRight->m_size == 0) {
+        return pLeft;
+    }
+    if (pLeft->m_size == 0) {
+        return pRight;
+    }
+
+    if (pLeft->m_size + pRight->m_size <= FLAT_MAX) {
+        std::string str;
+        str.reserve(pLeft->m_size + pRight->m_size);
+        str += pLeft->str();
+        str += pRight->str();
+        return make_ref<NexString>(std::move(str));
+    }
+
+    return Ref<NexString>(new NexString(pLeft, pRight));
+}
+
+void NexString::flatten() const
+{
+    std::string str;
+    str.reserve(m_size);
+
+    // Appends the leaves from left to right, without recursing down the
+    // left spine, which is as long as the loop that built the rope
+    std::vector<const NexString*> pending{ this };
+    while (!pending.empty()) {
+        auto pNode = pending.back();
+        pending.pop_back();
+        while (pNode->m_left) {
+            pending.push_back(pNode->m_right.get());
+            pNode = pNode->m_left.get();
+        }
+        str += pNode->m_str;
+    }
+
+    m_str = std::move(str);
+    m_left = nullptr;
+    m_right = nullptr;
+}
+
+}
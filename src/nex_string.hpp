@@ -0,0 +1,73 @@
+#ifndef NEX_STRING_HPP
+#define NEX_STRING_HPP
+
+#include "nex_object.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace nex {
+
+// An immutable string. Concatenating long strings makes a rope node that
+// only refers to both halves, the characters are copied once, when the
+// string is first read through str(), so building a string in a loop is
+// linear instead of quadratic.
+class NexString final : public Object
+{
+public:
+    explicit NexString(std::string str, bool bInterned = false)
+        : m_str(std::move(str))
+        , m_left()
+        , m_right()
+        , m_size(m_str.size())
+        , m_bInterned(bInterned)
+    {}
+
+    ~NexString() override;
+
+    // 'left' followed by 'right'
+    static Ref<NexString> concat(NexString* pLeft, NexString* pRight);
+
+    // Flattens a rope on first use
+    inline const std::string& str() const
+    {
+        if (m_left) {
+            flatten();
+        }
+        return m_str;
+    }
+
+    // Length in characters, a rope does not need to be flattened for it
+    inline size_t size() const
+    {
+        return m_size;
+    }
+
+    // Owned by the SymbolTable, two different interned strings are never
+    // equal
+    inline bool interned() const
+    {
+        return m_bInterned;
+    }
+
+private:
+    // Concatenations up to this many characters are copied right away, a
+    // rope node would cost more than the copy
+    static constexpr size_t FLAT_MAX = 128;
+
+    NexString(Ref<NexString> left, Ref<NexString> right);
+
+    void flatten() const;
+
+    // The characters, empty in a rope node until it is flattened
+    mutable std::string m_str;
+    // Halves of a rope node, released once it is flattened
+    mutable Ref<NexString> m_left;
+    mutable Ref<NexString> m_right;
+    const size_t m_size;
+    const bool m_bInterned;
+};
+
+}
+
+#endif
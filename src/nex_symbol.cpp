@@ -0,0 +1,29 @@
+#include "nex_symbol.hpp"
+
+namespace nex {
+
+Symbol SymbolTable::intern(std::string_view str)
+{
+    auto& symbols = table();
+    auto it = symbols.find(str);
+    if (it != symbols.end()) {
+        return it->second.get();
+    }
+
+    auto symbol = make_ref<NexString>(std::string(str), true);
+    symbols.emplace(symbol->str(), symbol);
+    return symbol.get();
+}
+
+size_t SymbolTable::size()
+{
+    return table().size();
+}
+
+std::unordered_map<std::string_view, Ref<NexString>>& SymbolTable::table()
+{
+    static std::unordered_map<std::string_view, Ref<NexString>> s_symbols;
+    return s_symbols;
+}
+
+}
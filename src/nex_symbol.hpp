@@ -0,0 +1,35 @@
+#ifndef NEX_SYMBOL_HPP
+#define NEX_SYMBOL_HPP
+
+#include "nex_object.hpp"
+#include "nex_string.hpp"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace nex {
+
+// Handle of an interned string. Equal names always get the same handle, so
+// symbols are compared and hashed by pointer.
+using Symbol = NexString*;
+
+// Process wide table of interned strings: identifiers, property names and
+// string literals. Interned strings live until the program exits.
+class SymbolTable final
+{
+public:
+    // The unique interned string equal to 'str', created on first use
+    static Symbol intern(std::string_view str);
+
+    static size_t size();
+
+private:
+    // Keys view the characters of the interned string they map to, so a
+    // lookup never copies the name
+    static std::unordered_map<std::string_view, Ref<NexString>>& table();
+};
+
+}
+
+#endif
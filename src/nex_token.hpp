@@ -1,66 +1,70 @@
 #ifndef NEX_TOKEN_HPP_
 #define NEX_TOKEN_HPP_
 
+#include "nex_symbol.hpp"
+#include "nex_value.hpp"
+
+#include <cassert>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <ostream>
-#include <any>
 
 namespace nex {
 
 #define TOKEN_LIST \
-    EMIT_TOKEN(LEFT_PAREN, L"LEFT_PAREN", L"(") \
-    EMIT_TOKEN(RIGHT_PAREN, L"RIGHT_PAREN", L")") \
-    EMIT_TOKEN(LEFT_BRACE, L"LEFT_BRACE", L"{") \
-    EMIT_TOKEN(RIGHT_BRACE, L"RIGHT_BRACE", L"}") \
-    EMIT_TOKEN(COMMA, L"COMMA", L",") \
-    EMIT_TOKEN(DOT, L"DOT", L".") \
-    EMIT_TOKEN(MINUS, L"MINUS", L"-") \
-    EMIT_TOKEN(PLUS, L"PLUS", L"+") \
-    EMIT_TOKEN(EXTENDS, L"EXTENDS", L"extends") \
-    EMIT_TOKEN(ELLIPSIS, L"ELLIPSIS", L"...") \
-    EMIT_TOKEN(COLON, L"COLON", L":") \
-    EMIT_TOKEN(SEMICOLON, L"SEMICOLON", L";") \
-    EMIT_TOKEN(SLASH, L"SLASH", L"/") \
-    EMIT_TOKEN(STAR, L"STAR", L"*") \
-    EMIT_TOKEN(ARROW, L"ARROW", L"->") \
-    EMIT_TOKEN(BANG, L"BANG", L"!") \
-    EMIT_TOKEN(BANG_EQUAL, L"BANG_EQUAL", L"!=") \
-    EMIT_TOKEN(EQUAL, L"EQUAL", L"=") \
-    EMIT_TOKEN(EQUAL_EQUAL, L"EQUAL_EQUAL", L"==") \
-    EMIT_TOKEN(GREATER, L"GREATER", L">") \
-    EMIT_TOKEN(GREATER_EQUAL, L"GREATER_EQUAL", L">=") \
-    EMIT_TOKEN(LESS, L"LESS", L"<") \
-    EMIT_TOKEN(LESS_EQUAL, L"LESS_EQUAL", L"<=") \
-    EMIT_TOKEN(QUESTION_MARK, L"QUESTION_MARK", L"?") \
-    EMIT_TOKEN(IDENTIFIER, L"IDENTIFIER", L"id") \
-    EMIT_TOKEN(STRING, L"STRING", L"str") \
-    EMIT_TOKEN(NUMBER, L"NUMBER", L"num") \
-    EMIT_TOKEN(TYPE_INT, L"TYPE_INT", L"Int") \
-    EMIT_TOKEN(TYPE_VOID, L"TYPE_VOID", L"Void") \
-    EMIT_TOKEN(TYPE_STRING, L"TYPE_STRING", L"String") \
-    EMIT_TOKEN(AND, L"AND", L"and") \
-    EMIT_TOKEN(CLASS, L"CLASS", L"class") \
-    EMIT_TOKEN(ELSE, L"ELSE", L"else") \
-    EMIT_TOKEN(FALSE, L"FALSE", L"false") \
-    EMIT_TOKEN(FUNC, L"FUNC", L"func") \
-    EMIT_TOKEN(IF, L"IF", L"if") \
-    EMIT_TOKEN(NIL, L"NIL", L"nil") \
-    EMIT_TOKEN(OR, L"OR", L"or") \
-    EMIT_TOKEN(FOR, L"FOR", L"for") \
-    EMIT_TOKEN(TEST, L"TEST", L"test") \
-    EMIT_TOKEN(PRINT, L"PRINT", L"print") \
-    EMIT_TOKEN(INPUT, L"INPUT", L"input") \
-    EMIT_TOKEN(READ, L"READ", L"read") \
-    EMIT_TOKEN(RET, L"RET", L"ret") \
-    EMIT_TOKEN(SUPER, L"SUPER", L"super") \
-    EMIT_TOKEN(THIS, L"THIS", L"this") \
-    EMIT_TOKEN(TRUE, L"TRUE", L"true") \
-    EMIT_TOKEN(CONST, L"CONST", L"const") \
-    EMIT_TOKEN(LET, L"LET", L"let") \
-    EMIT_TOKEN(WHILE, L"WHILE", L"while") \
-    EMIT_TOKEN(TYPE_OF, L"TYPE_OF", L"typeof") \
-    EMIT_TOKEN(END_OF_FILE, L"END_OF_FILE", L"EOF")
+    EMIT_TOKEN(LEFT_PAREN, "LEFT_PAREN", "(") \
+    EMIT_TOKEN(RIGHT_PAREN, "RIGHT_PAREN", ")") \
+    EMIT_TOKEN(LEFT_BRACE, "LEFT_BRACE", "{") \
+    EMIT_TOKEN(RIGHT_BRACE, "RIGHT_BRACE", "}") \
+    EMIT_TOKEN(COMMA, "COMMA", ",") \
+    EMIT_TOKEN(DOT, "DOT", ".") \
+    EMIT_TOKEN(MINUS, "MINUS", "-") \
+    EMIT_TOKEN(PLUS, "PLUS", "+") \
+    EMIT_TOKEN(EXTENDS, "EXTENDS", "extends") \
+    EMIT_TOKEN(ELLIPSIS, "ELLIPSIS", "...") \
+    EMIT_TOKEN(COLON, "COLON", ":") \
+    EMIT_TOKEN(SEMICOLON, "SEMICOLON", ";") \
+    EMIT_TOKEN(SLASH, "SLASH", "/") \
+    EMIT_TOKEN(STAR, "STAR", "*") \
+    EMIT_TOKEN(ARROW, "ARROW", "->") \
+    EMIT_TOKEN(BANG, "BANG", "!") \
+    EMIT_TOKEN(BANG_EQUAL, "BANG_EQUAL", "!=") \
+    EMIT_TOKEN(EQUAL, "EQUAL", "=") \
+    EMIT_TOKEN(EQUAL_EQUAL, "EQUAL_EQUAL", "==") \
+    EMIT_TOKEN(GREATER, "GREATER", ">") \
+    EMIT_TOKEN(GREATER_EQUAL, "GREATER_EQUAL", ">=") \
+    EMIT_TOKEN(LESS, "LESS", "<") \
+    EMIT_TOKEN(LESS_EQUAL, "LESS_EQUAL", "<=") \
+    EMIT_TOKEN(QUESTION_MARK, "QUESTION_MARK", "?") \
+    EMIT_TOKEN(IDENTIFIER, "IDENTIFIER", "id") \
+    EMIT_TOKEN(STRING, "STRING", "str") \
+    EMIT_TOKEN(NUMBER, "NUMBER", "num") \
+    EMIT_TOKEN(TYPE_INT, "TYPE_INT", "Int") \
+    EMIT_TOKEN(TYPE_VOID, "TYPE_VOID", "Void") \
+    EMIT_TOKEN(TYPE_STRING, "TYPE_STRING", "String") \
+    EMIT_TOKEN(AND, "AND", "and") \
+    EMIT_TOKEN(CLASS, "CLASS", "class") \
+    EMIT_TOKEN(ELSE, "ELSE", "else") \
+    EMIT_TOKEN(FALSE, "FALSE", "false") \
+    EMIT_TOKEN(FUNC, "FUNC", "func") \
+    EMIT_TOKEN(IF, "IF", "if") \
+    EMIT_TOKEN(NIL, "NIL", "nil") \
+    EMIT_TOKEN(OR, "OR", "or") \
+    EMIT_TOKEN(FOR, "FOR", "for") \
+    EMIT_TOKEN(TEST, "TEST", "test") \
+    EMIT_TOKEN(PRINT, "PRINT", "print") \
+    EMIT_TOKEN(INPUT, "INPUT", "input") \
+    EMIT_TOKEN(READ, "READ", "read") \
+    EMIT_TOKEN(RET, "RET", "ret") \
+    EMIT_TOKEN(SUPER, "SUPER", "super") \
+    EMIT_TOKEN(THIS, "THIS", "this") \
+    EMIT_TOKEN(TRUE, "TRUE", "true") \
+    EMIT_TOKEN(CONST, "CONST", "const") \
+    EMIT_TOKEN(LET, "LET", "let") \
+    EMIT_TOKEN(WHILE, "WHILE", "while") \
+    EMIT_TOKEN(TYPE_OF, "TYPE_OF", "typeof") \
+    EMIT_TOKEN(END_OF_FILE, "END_OF_FILE", "EOF")
 
 #define EMIT_TOKEN(id, str, token) id,
 enum TokenType {
@@ -69,10 +73,10 @@ enum TokenType {
     TOKEN_NUM
 };
 
-inline std::wstring tokenToStr(TokenType token) {
+inline std::string tokenToStr(TokenType token) {
     assert(token < TOKEN_NUM);
 #define EMIT_TOKEN(id, str, token) str,
-    const std::wstring tokens[] = { 
+    const std::string tokens[] = { 
         TOKEN_LIST
 #undef EMIT_TOKEN
     };
@@ -82,26 +86,59 @@ inline std::wstring tokenToStr(TokenType token) {
 class Token final
 {
 public:
-    Token(TokenType type, std::wstring lexeme, std::any literal, int line)
+    Token(TokenType type, std::string_view lexeme, Value literal, int line)
         : m_type(type)
         , m_lexeme(lexeme)
+        , m_symbol(type == IDENTIFIER || type == THIS || type == SUPER ?
+                   SymbolTable::intern(m_lexeme) : nullptr)
         , m_literal(literal)
         , m_line(line)
     {}
 
     ~Token() = default;
 
-    std::wstring toString() const
+    std::string toString() const
+    {
+        std::stringstream ss;
+        ss << m_type << " " << m_lexeme << " " << Value::typeName(m_literal.type()) << " " << m_line;
+        return ss.str();
+    }
+
+    const TokenType m_type;
+    // View of the source the Lexer ran over, which must outlive the tokens
+    const std::string_view m_lexeme;
+    // Interned lexeme of names (identifiers, 'this' and 'super'), null for
+    // every other token
+    const Symbol m_symbol;
+    Value m_literal;
+    const int m_line;
+};
+
+// Compact copy of a token kept by the AST: the type, the line and the
+// interned lexeme. Literal values are stored by the Literal node itself.
+class SlimToken final
+{
+public:
+    SlimToken(const Token& token)
+        : m_type(token.m_type)
+        , m_line(token.m_line)
+        , m_symbol(token.m_symbol ? token.m_symbol : SymbolTable::intern(token.m_lexeme))
+    {}
+
+    SlimToken(TokenType type, Symbol symbol, int line)
+        : m_type(type)
+        , m_line(line)
+        , m_symbol(symbol)
+    {}
+
+    inline const std::string& lexeme() const
     {
-        std::wstringstream wss;
-        wss << m_type << " " << m_lexeme << " " << m_literal.type().name() << " " << m_line;
-        return wss.str();
+        return m_symbol->str();
     }
 
     const TokenType m_type;
-    const std::wstring m_lexeme;
-    std::any m_literal;
     const int m_line;
+    const Symbol m_symbol;
 };
 
 
@@ -0,0 +1,105 @@
+#include "nex_value.hpp"
+#include "nex_callable.hpp"
+#include "nex_instance.hpp"
+#include "nex_vm_object.hpp"
+
+#include <sstream>
+
+namespace nex {
+
+bool Value::operator==(const Value& other) const
+{
+    if (m_type != other.m_type) {
+        return false;
+    }
+
+    switch (m_type) {
+    case ValueType::NIL:
+        return true;
+    case ValueType::BOOL:
+        return m_as.boolean == other.m_as.boolean;
+    case ValueType::NUMBER:
+        return m_as.number == other.m_as.number;
+    case ValueType::STRING:
+    {
+        auto pLeft = asString();
+        auto pRight = other.asString();
+        if (pLeft == pRight) {
+            return true;
+        }
+        if (pLeft->interned() && pRight->interned()) {
+            return false;
+        }
+        if (pLeft->size() != pRight->size()) {
+            return false;
+        }
+        return pLeft->str() == pRight->str();
+    }
+    default:
+        return m_as.pObject == other.m_as.pObject;
+    }
+}
+
+std::string Value::toString() const
+{
+    std::stringstream ss;
+    switch (m_type) {
+    case ValueType::NUMBER:
+        ss << m_as.number;
+        break;
+    case ValueType::STRING:
+        ss << asString()->str();
+        break;
+    case ValueType::BOOL:
+        ss << (m_as.boolean ? "true" : "false");
+        break;
+    case ValueType::CALLABLE:
+    case ValueType::CLASS:
+        ss << asCallable()->to_string();
+        break;
+    case ValueType::INSTANCE:
+        ss << asInstance()->to_string();
+        break;
+    case ValueType::VM_FUNCTION:
+        ss << "<func '" << as<vm::Function>()->m_name << "'>";
+        break;
+    case ValueType::VM_CLOSURE:
+        ss << "<func '" << as<vm::Closure>()->m_function->m_name << "'>";
+        break;
+    case ValueType::VM_BOUND_METHOD:
+        ss << "<func '" << as<vm::BoundMethod>()->m_method->m_function->m_name << "'>";
+        break;
+    case ValueType::VM_CLASS:
+        ss << "<class '" << as<vm::Class>()->m_name << "'>";
+        break;
+    case ValueType::VM_INSTANCE:
+        ss << "<'" << as<vm::Instance>()->m_klass->m_name << "' instance>";
+        break;
+    default:
+        ss << "nil";
+        break;
+    }
+    return ss.str();
+}
+
+const char* Value::typeName(ValueType type)
+{
+    switch (type) {
+    case ValueType::NIL: return "nil";
+    case ValueType::BOOL: return "bool";
+    case ValueType::NUMBER: return "number";
+    case ValueType::STRING: return "string";
+    case ValueType::CALLABLE: return "callable";
+    case ValueType::CLASS: return "class";
+    case ValueType::INSTANCE: return "instance";
+    case ValueType::CELL: return "cell";
+    case ValueType::VM_FUNCTION: return "function";
+    case ValueType::VM_CLOSURE: return "closure";
+    case ValueType::VM_BOUND_METHOD: return "bound method";
+    case ValueType::VM_CLASS: return "class";
+    case ValueType::VM_INSTANCE: return "instance";
+    }
+    return "unknown";
+}
+
+}
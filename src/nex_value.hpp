@@ -0,0 +1,168 @@
+#ifndef NEX_VALUE_HPP
+#define NEX_VALUE_HPP
+
+#include "nex_object.hpp"
+#include "nex_string.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace nex {
+
+class Cell;
+class NexCallable;
+class NexClass;
+class NexInstance;
+
+enum class ValueType : uint8_t {
+    NIL,
+    BOOL,
+    NUMBER,
+    // Heap types, the payload is an Object*
+    STRING,
+    CALLABLE,
+    CLASS,
+    INSTANCE,
+    // Captured local, only ever stored in an interpreter frame slot
+    CELL,
+    // Bytecode VM types, see nex_vm_object.hpp
+    VM_FUNCTION,
+    VM_CLOSURE,
+    VM_BOUND_METHOD,
+    VM_CLASS,
+    VM_INSTANCE,
+};
+
+// A runtime value: a type tag followed by an 8 byte payload. Numbers and
+// booleans are stored inline, every other type holds a reference to an
+// Object.
+class Value final
+{
+public:
+    Value() : m_type(ValueType::NIL)
+    {
+        m_as.number = 0;
+    }
+
+    Value(std::nullptr_t) : Value() {}
+
+    Value(bool boolean) : m_type(ValueType::BOOL)
+    {
+        m_as.number = 0;
+        m_as.boolean = boolean;
+    }
+
+    Value(double number) : m_type(ValueType::NUMBER)
+    {
+        m_as.number = number;
+    }
+
+    Value(NexString* pStr) : Value(ValueType::STRING, pStr) {}
+    Value(const std::string& str) : Value(new NexString(str)) {}
+    Value(const char* str) : Value(new NexString(str)) {}
+
+    // Defined next to the type they wrap
+    Value(NexCallable* pCallable);
+    Value(NexClass* pKlass);
+    Value(NexInstance* pInstance);
+    Value(Cell* pCell);
+
+    template <typename T>
+    Value(const Ref<T>& ref) : Value(ref.get()) {}
+
+    Value(ValueType type, Object* pObject) : m_type(type)
+    {
+        m_as.pObject = pObject;
+        m_as.pObject->retain();
+    }
+
+    Value(const Value& other) : m_type(other.m_type), m_as(other.m_as)
+    {
+        if (isObject()) m_as.pObject->retain();
+    }
+
+    Value(Value&& other) noexcept : m_type(other.m_type), m_as(other.m_as)
+    {
+        other.m_type = ValueType::NIL;
+    }
+
+    ~Value()
+    {
+        if (isObject()) m_as.pObject->release();
+    }
+
+    Value& operator=(Value other) noexcept
+    {
+        std::swap(m_type, other.m_type);
+        std::swap(m_as, other.m_as);
+        return *this;
+    }
+
+    inline ValueType type() const { return m_type; }
+
+    inline bool isNil() const { return m_type == ValueType::NIL; }
+    inline bool isBool() const { return m_type == ValueType::BOOL; }
+    inline bool isNumber() const { return m_type == ValueType::NUMBER; }
+    inline bool isString() const { return m_type == ValueType::STRING; }
+    inline bool isClass() const { return m_type == ValueType::CLASS; }
+    inline bool isInstance() const { return m_type == ValueType::INSTANCE; }
+    inline bool isObject() const { return m_type >= ValueType::STRING; }
+
+    // Classes are callable too
+    inline bool isCallable() const
+    {
+        return m_type == ValueType::CALLABLE || m_type == ValueType::CLASS;
+    }
+
+    inline bool asBool() const { return m_as.boolean; }
+    inline double asNumber() const { return m_as.number; }
+    inline Object* asObject() const { return m_as.pObject; }
+
+    inline NexString* asString() const
+    {
+        return static_cast<NexString*>(m_as.pObject);
+    }
+
+    inline NexCallable* asCallable() const;
+    inline NexClass* asClass() const;
+    inline NexInstance* asInstance() const;
+
+    template <typename T>
+    inline T* as() const
+    {
+        return static_cast<T*>(m_as.pObject);
+    }
+
+    inline bool isTruthy() const
+    {
+        if (m_type == ValueType::NIL) return false;
+        if (m_type == ValueType::BOOL) return m_as.boolean;
+        return true;
+    }
+
+    bool operator==(const Value& other) const;
+
+    inline bool operator!=(const Value& other) const
+    {
+        return !(*this == other);
+    }
+
+    std::string toString() const;
+
+    static const char* typeName(ValueType type);
+
+private:
+    ValueType m_type;
+    union {
+        bool boolean;
+        double number;
+        Object* pObject;
+    } m_as;
+};
+
+static_assert(sizeof(Value) == 16, "Value must stay a 16 byte tagged union");
+
+}
+
+#endif
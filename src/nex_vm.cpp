@@ -0,0 +1,616 @@
+#include "nex_vm.hpp"
+#include "nex_compiler.hpp"
+#include "nex_callable.hpp"
+#include "nex_diag.hpp"
+#include "nex_runtime.hpp"
+
+#include <iostream>
+
+namespace nex {
+
+using namespace nex::runtime;
+
+VM::VM()
+    : m_bHadRuntimeError(false)
+    , m_stack(STACK_MAX)
+    , m_pStackTop(m_stack.data())
+    , m_frames(FRAMES_MAX)
+    , m_frameCount(0)
+    , m_pOpenUpvalues(nullptr)
+    , m_globals()
+    , m_globalSlots()
+    , m_initSymbol(SymbolTable::intern("init"))
+{
+    // Insert native functions to the global table
+#define EMIT_NATIVE_FN(name, function)  \
+    defineNative<function>(name);
+    NATIVE_FN_LIST
+#undef EMIT_NATIVE_FN
+}
+
+void VM::defineNative(Ref<NativeFunction> function)
+{
+    auto& global = m_globals[globalSlot(SymbolTable::intern(function->name()))];
+    global.value = function;
+    global.bDefined = true;
+    global.bNative = true;
+}
+
+void VM::interpret(ArenaList<stmt::Stmt*> stmts)
+{
+    Compiler compiler(*this);
+    auto script = compiler.compile(stmts);
+
+    if (!script) {
+        return;
+    }
+
+    auto closure = Heap::make<vm::Closure>(script);
+    push(Value(ValueType::VM_CLOSURE, closure.get()));
+    if (!call(closure.get(), 0) || !run(0)) {
+        m_bHadRuntimeError = true;
+        return;
+    }
+
+    pop();
+}
+
+size_t VM::globalSlot(Symbol name)
+{
+    auto it = m_globalSlots.find(name);
+    if (it != m_globalSlots.end()) {
+        return it->second;
+    }
+
+    auto slot = m_globals.size();
+    m_globals.push_back({ name, Value(), false, false });
+    m_globalSlots[name] = slot;
+    return slot;
+}
+
+bool VM::run(size_t exitDepth)
+{
+    CallFrame* frame = &m_frames[m_frameCount - 1];
+    const uint8_t* ip = frame->ip;
+
+#define READ_BYTE() (*ip++)
+#define READ_SHORT() (ip += 2, static_cast<uint16_t>((ip[-2] << 8) | ip[-1]))
+#define READ_CONSTANT() (frame->pClosure->m_function->m_chunk.m_constants[READ_SHORT()])
+#define READ_NAME() (READ_CONSTANT().asString())
+#define RUNTIME_ERROR(msg)      \
+    do {                        \
+        frame->ip = ip;         \
+        runtimeError(msg);      \
+        return false;           \
+    } while (0)
+#define NUMBER_OPERANDS()                                           \
+    do {                                                            \
+        if (!peek(0).isNumber() || !peek(1).isNumber()) {           \
+            RUNTIME_ERROR("Operands muse be numbers.");            \
+        }                                                           \
+    } while (0)
+#define BINARY_OP(op)                                               \
+    do {                                                            \
+        NUMBER_OPERANDS();                                          \
+        double b = pop().asNumber();                                \
+        peek(0) = peek(0).asNumber() op b;                          \
+    } while (0)
+// Calls may push a frame or re-enter run(), reload the cached state after
+#define SAVE_FRAME() (frame->ip = ip)
+#define LOAD_FRAME()                                \
+    do {                                            \
+        frame = &m_frames[m_frameCount - 1];        \
+        ip = frame->ip;                             \
+    } while (0)
+
+    while (true) {
+#if defined(DBG_BYTECODE)
+        auto& chunk = frame->pClosure->m_function->m_chunk;
+        chunk.disassembleInstruction(ip - chunk.m_code.data());
+#endif
+        auto instruction = static_cast<OpCode>(READ_BYTE());
+        switch (instruction) {
+        case OP_CONSTANT:
+            push(READ_CONSTANT());
+            break;
+        case OP_NIL: push(Value()); break;
+        case OP_TRUE: push(true); break;
+        case OP_FALSE: push(false); break;
+        case OP_POP: pop(); break;
+        case OP_GET_LOCAL:
+            push(frame->pSlots[READ_BYTE()]);
+            break;
+        case OP_SET_LOCAL:
+            frame->pSlots[READ_BYTE()] = peek(0);
+            break;
+        case OP_GET_GLOBAL:
+        {
+            auto& global = m_globals[READ_SHORT()];
+            if (!global.bDefined) {
+                RUNTIME_ERROR("Undefined symbol '" + global.name->str() + "'.");
+            }
+            push(global.value);
+            break;
+        }
+        case OP_DEFINE_GLOBAL:
+        {
+            auto& global = m_globals[READ_SHORT()];
+            if (global.bDefined && !global.bNative) {
+                RUNTIME_ERROR("Symbol '" + global.name->str() + "' has already been declared");
+            }
+            global.value = pop();
+            global.bDefined = true;
+            global.bNative = false;
+            break;
+        }
+        case OP_SET_GLOBAL:
+        {
+            auto& global = m_globals[READ_SHORT()];
+            if (!global.bDefined) {
+                RUNTIME_ERROR("Undefined symbol '" + global.name->str() + "'.");
+            }
+            global.value = peek(0);
+            break;
+        }
+        case OP_GET_UPVALUE:
+            push(*frame->pClosure->m_upvalues[READ_BYTE()]->m_pLocation);
+            break;
+        case OP_SET_UPVALUE:
+            *frame->pClosure->m_upvalues[READ_BYTE()]->m_pLocation = peek(0);
+            break;
+        case OP_GET_PROPERTY:
+        {
+            auto name = READ_NAME();
+            if (peek(0).type() != ValueType::VM_INSTANCE) {
+                RUNTIME_ERROR("Object has not property '" + name->str() + "'");
+            }
+
+            auto pInstance = peek(0).as<vm::Instance>();
+            auto it = pInstance->m_fields.find(name);
+            if (it != pInstance->m_fields.end()) {
+                peek(0) = it->second;
+                break;
+            }
+
+            if (!bindMethod(pInstance->m_klass.get(), name)) {
+                RUNTIME_ERROR(pInstance->m_klass->m_name + " object has not property '" + name->str() + "'");
+            }
+            break;
+        }
+        case OP_SET_PROPERTY:
+        {
+            auto name = READ_NAME();
+            if (peek(1).type() != ValueType::VM_INSTANCE) {
+                RUNTIME_ERROR("Object has not property '" + name->str() + "'");
+            }
+
+            auto pInstance = peek(1).as<vm::Instance>();
+            auto it = pInstance->m_fields.find(name);
+            if (it == pInstance->m_fields.end()) {
+                RUNTIME_ERROR(pInstance->m_klass->m_name + " object has not property '" + name->str() + "'");
+            }
+
+            it->second = peek(0);
+            auto value = pop();
+            peek(0) = std::move(value);
+            break;
+        }
+        case OP_GET_SUPER:
+        {
+            auto name = READ_NAME();
+            auto superclass = pop();
+            if (!bindMethod(superclass.as<vm::Class>(), name)) {
+                RUNTIME_ERROR("Undefined property '" + name->str() + "'.");
+            }
+            break;
+        }
+        case OP_EQUAL:
+        {
+            auto b = pop();
+            peek(0) = peek(0) == b;
+            break;
+        }
+        case OP_NOT_EQUAL:
+        {
+            auto b = pop();
+            peek(0) = peek(0) != b;
+            break;
+        }
+        case OP_GREATER: BINARY_OP(>); break;
+        case OP_GREATER_EQUAL: BINARY_OP(>=); break;
+        case OP_LESS: BINARY_OP(<); break;
+        case OP_LESS_EQUAL: BINARY_OP(<=); break;
+        case OP_SUBTRACT: BINARY_OP(-); break;
+        case OP_MULTIPLY: BINARY_OP(*); break;
+        case OP_DIVIDE:
+        {
+            NUMBER_OPERANDS();
+            double b = pop().asNumber();
+            if (b == 0) {
+                RUNTIME_ERROR("Division by zero");
+            }
+            peek(0) = peek(0).asNumber() / b;
+            break;
+        }
+        case OP_ADD:
+        {
+            if (peek(0).isNumber() && peek(1).isNumber()) {
+                double b = pop().asNumber();
+                peek(0) = peek(0).asNumber() + b;
+            }
+            else if (peek(0).isString() && peek(1).isString()) {
+                auto b = pop();
+                peek(0) = NexString::concat(peek(0).asString(), b.asString());
+            }
+            else {
+                RUNTIME_ERROR("Operans must be two numbers or two strings");
+            }
+            break;
+        }
+        case OP_NOT:
+            peek(0) = !peek(0).isTruthy();
+            break;
+        case OP_NEGATE:
+            if (!peek(0).isNumber()) {
+                RUNTIME_ERROR("Operand must be a number");
+            }
+            peek(0) = -peek(0).asNumber();
+            break;
+        case OP_PRINT:
+            std::cout << pop().toString() << std::endl;
+            break;
+        case OP_INPUT:
+        {
+            std::string in;
+            std::cin >> in;
+            push(in);
+            break;
+        }
+        case OP_JUMP:
+        {
+            auto offset = READ_SHORT();
+            ip += offset;
+            break;
+        }
+        case OP_JUMP_IF_FALSE:
+        {
+            auto offset = READ_SHORT();
+            if (!peek(0).isTruthy()) {
+                ip += offset;
+            }
+            break;
+        }
+        case OP_LOOP:
+        {
+            auto offset = READ_SHORT();
+            ip -= offset;
+            break;
+        }
+        case OP_CALL:
+        {
+            size_t argc = READ_BYTE();
+            SAVE_FRAME();
+            if (!callValue(peek(argc), argc)) {
+                return false;
+            }
+            LOAD_FRAME();
+            break;
+        }
+        case OP_INVOKE:
+        {
+            auto name = READ_NAME();
+            size_t argc = READ_BYTE();
+            SAVE_FRAME();
+            if (!invoke(name, argc)) {
+                return false;
+            }
+            LOAD_FRAME();
+            break;
+        }
+        case OP_SUPER_INVOKE:
+        {
+            auto name = READ_NAME();
+            size_t argc = READ_BYTE();
+            auto superclass = pop();
+            auto pKlass = superclass.as<vm::Class>();
+
+            auto it = pKlass->m_methods.find(name);
+            if (it == pKlass->m_methods.end()) {
+                RUNTIME_ERROR("Undefined property '" + name->str() + "'.");
+            }
+
+            SAVE_FRAME();
+            if (!call(it->second.as<vm::Closure>(), argc)) {
+                return false;
+            }
+            LOAD_FRAME();
+            break;
+        }
+        case OP_CLOSURE:
+        {
+            auto function = READ_CONSTANT().as<vm::Function>();
+            auto closure = Heap::make<vm::Closure>(function);
+            for (size_t idx = 0; idx < closure->m_upvalues.size(); idx++) {
+                auto bIsLocal = READ_BYTE();
+                auto index = READ_BYTE();
+                if (bIsLocal) {
+                    closure->m_upvalues[idx] = captureUpvalue(frame->pSlots + index);
+                }
+                else {
+                    closure->m_upvalues[idx] = frame->pClosure->m_upvalues[index];
+                }
+            }
+            push(Value(ValueType::VM_CLOSURE, closure.get()));
+            break;
+        }
+        case OP_CLOSE_UPVALUE:
+            closeUpvalues(m_pStackTop - 1);
+            pop();
+            break;
+        case OP_RETURN:
+        {
+            auto result = pop();
+            closeUpvalues(frame->pSlots);
+            m_frameCount--;
+            popTo(frame->pSlots);
+            push(result);
+
+            if (m_frameCount == exitDepth) {
+                return true;
+            }
+
+            LOAD_FRAME();
+            break;
+        }
+        case OP_CLASS:
+            push(Value(ValueType::VM_CLASS, Heap::make<vm::Class>(READ_NAME()->str()).get()));
+            break;
+        case OP_INHERIT:
+        {
+            auto& superclass = peek(1);
+            if (superclass.type() != ValueType::VM_CLASS) {
+                RUNTIME_ERROR("Superclass must be a class.");
+            }
+
+            auto pSubclass = peek(0).as<vm::Class>();
+            pSubclass->m_methods = superclass.as<vm::Class>()->m_methods;
+            pop();
+            break;
+        }
+        case OP_METHOD:
+        {
+            auto name = READ_NAME();
+            peek(1).as<vm::Class>()->m_methods[name] = peek(0);
+            pop();
+            break;
+        }
+        case OP_FIELDS:
+            peek(1).as<vm::Class>()->m_fieldInit = peek(0);
+            pop();
+            break;
+        case OP_DEFINE_FIELD:
+        {
+            auto name = READ_NAME();
+            peek(1).as<vm::Instance>()->m_fields[name] = peek(0);
+            pop();
+            pop();
+            break;
+        }
+        default:
+            RUNTIME_ERROR("Unknown opcode " + opcodeToStr(instruction));
+        }
+    }
+
+#undef READ_BYTE
+#undef READ_SHORT
+#undef READ_CONSTANT
+#undef READ_NAME
+#undef RUNTIME_ERROR
+#undef NUMBER_OPERANDS
+#undef BINARY_OP
+#undef SAVE_FRAME
+#undef LOAD_FRAME
+}
+
+bool VM::call(vm::Closure* pClosure, size_t argc)
+{
+    auto& function = *pClosure->m_function;
+    if (argc != function.m_arity) {
+        runtimeError("'" + function.m_name +
+            "' expected " + std::to_string(function.m_arity) +
+            " arguments but got " +
+            std::to_string(argc) + ".");
+        return false;
+    }
+
+    // The compiler counted the slots the function may push
+    auto pSlots = m_pStackTop - argc - 1;
+    if (m_frameCount == FRAMES_MAX ||
+        pSlots + function.m_maxSlots > m_stack.data() + STACK_MAX) {
+        runtimeError("Stack overflow.");
+        return false;
+    }
+
+    auto& frame = m_frames[m_frameCount++];
+    frame.pClosure = pClosure;
+    frame.ip = function.m_chunk.m_code.data();
+    frame.pSlots = pSlots;
+    return true;
+}
+
+bool VM::callValue(const Value& callee, size_t argc)
+{
+    switch (callee.type()) {
+    case ValueType::VM_CLOSURE:
+        return call(callee.as<vm::Closure>(), argc);
+    case ValueType::VM_BOUND_METHOD:
+    {
+        // The slot may hold the last reference to the bound method, keep
+        // what is needed from it before overwriting the slot
+        auto pBound = callee.as<vm::BoundMethod>();
+        Ref<vm::Closure> method = pBound->m_method;
+        Value receiver = pBound->m_receiver;
+        peek(argc) = receiver;
+        return call(method.get(), argc);
+    }
+    case ValueType::VM_CLASS:
+        return instantiate(callee.as<vm::Class>(), argc);
+    case ValueType::CALLABLE:
+    {
+        auto pCallable = callee.asCallable();
+        if (argc != pCallable->arity()) {
+            runtimeError("'" + pCallable->name() +
+                "' expected " + std::to_string(pCallable->arity()) +
+                " arguments but got " +
+                std::to_string(argc) + ".");
+            return false;
+        }
+
+        Value result;
+        try {
+            result = pCallable->call(nullptr, Arguments(m_pStackTop - argc, argc));
+        } catch (const NativeError& e) {
+            runtimeError(e.msg());
+            return false;
+        }
+        popTo(m_pStackTop - argc - 1);
+        push(result);
+        return true;
+    }
+    default:
+        runtimeError("Can only call functions and classes");
+        return false;
+    }
+}
+
+bool VM::instantiate(vm::Class* pKlass, size_t argc)
+{
+    Value instance(ValueType::VM_INSTANCE, Heap::make<vm::Instance>(pKlass).get());
+    peek(argc) = instance;
+
+    // Field initializers run to completion before 'init' is entered
+    if (!pKlass->m_fieldInit.isNil()) {
+        if (m_pStackTop == m_stack.data() + STACK_MAX) {
+            runtimeError("Stack overflow.");
+            return false;
+        }
+        push(instance);
+        if (!call(pKlass->m_fieldInit.as<vm::Closure>(), 0) || !run(m_frameCount - 1)) {
+            return false;
+        }
+        pop();
+    }
+
+    auto it = pKlass->m_methods.find(m_initSymbol);
+    auto pInit = it != pKlass->m_methods.end() ? it->second.as<vm::Closure>() : nullptr;
+    size_t arity = pInit ? pInit->m_function->m_arity : 0;
+
+    if (argc != arity) {
+        runtimeError("'" + pKlass->m_name +
+            "' expected " + std::to_string(arity) +
+            " arguments but got " +
+            std::to_string(argc) + ".");
+        return false;
+    }
+
+    return pInit ? call(pInit, argc) : true;
+}
+
+bool VM::invoke(Symbol name, size_t argc)
+{
+    auto& receiver = peek(argc);
+    if (receiver.type() != ValueType::VM_INSTANCE) {
+        runtimeError("Object has not property '" + name->str() + "'");
+        return false;
+    }
+
+    auto pInstance = receiver.as<vm::Instance>();
+    auto it = pInstance->m_fields.find(name);
+    if (it != pInstance->m_fields.end()) {
+        auto field = it->second;
+        peek(argc) = field;
+        return callValue(field, argc);
+    }
+
+    return invokeFromClass(pInstance->m_klass.get(), name, argc);
+}
+
+bool VM::invokeFromClass(vm::Class* pKlass, Symbol name, size_t argc)
+{
+    auto it = pKlass->m_methods.find(name);
+    if (it == pKlass->m_methods.end()) {
+        runtimeError(pKlass->m_name + " object has not property '" + name->str() + "'");
+        return false;
+    }
+
+    return call(it->second.as<vm::Closure>(), argc);
+}
+
+bool VM::bindMethod(vm::Class* pKlass, Symbol name)
+{
+    auto it = pKlass->m_methods.find(name);
+    if (it == pKlass->m_methods.end()) {
+        return false;
+    }
+
+    auto bound = Heap::make<vm::BoundMethod>(peek(0), it->second.as<vm::Closure>());
+    peek(0) = Value(ValueType::VM_BOUND_METHOD, bound.get());
+    return true;
+}
+
+Ref<vm::Upvalue> VM::captureUpvalue(Value* pLocal)
+{
+    vm::Upvalue* pPrev = nullptr;
+    auto pUpvalue = m_pOpenUpvalues.get();
+    while (pUpvalue && pUpvalue->m_pLocation > pLocal) {
+        pPrev = pUpvalue;
+        pUpvalue = pUpvalue->m_pNext.get();
+    }
+
+    if (pUpvalue && pUpvalue->m_pLocation == pLocal) {
+        return pUpvalue;
+    }
+
+    auto created = Heap::make<vm::Upvalue>(pLocal);
+    created->m_pNext = pUpvalue;
+
+    if (pPrev) {
+        pPrev->m_pNext = created;
+    }
+    else {
+        m_pOpenUpvalues = created;
+    }
+
+    return created;
+}
+
+void VM::closeUpvalues(Value* pLast)
+{
+    while (m_pOpenUpvalues && m_pOpenUpvalues->m_pLocation >= pLast) {
+        auto pUpvalue = m_pOpenUpvalues;
+        pUpvalue->m_closed = *pUpvalue->m_pLocation;
+        pUpvalue->m_pLocation = &pUpvalue->m_closed;
+        m_pOpenUpvalues = pUpvalue->m_pNext;
+        pUpvalue->m_pNext = nullptr;
+    }
+}
+
+void VM::runtimeError(const std::string& msg)
+{
+    auto& frame = m_frames[m_frameCount - 1];
+    auto& chunk = frame.pClosure->m_function->m_chunk;
+    size_t offset = frame.ip - chunk.m_code.data() - 1;
+    ::nex::runtimeError(chunk.m_lines[offset], msg);
+    resetStack();
+}
+
+void VM::resetStack()
+{
+    while (m_pStackTop != m_stack.data()) {
+        pop();
+    }
+    m_frameCount = 0;
+    m_pOpenUpvalues = nullptr;
+}
+
+}
@@ -0,0 +1,124 @@
+#ifndef NEX_VM_HPP
+#define NEX_VM_HPP
+
+#include "nex_chunk.hpp"
+#include "nex_native.hpp"
+#include "nex_stmt.hpp"
+#include "nex_symbol.hpp"
+#include "nex_value.hpp"
+#include "nex_vm_object.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nex {
+
+using namespace nex::ast;
+
+// Stack based virtual machine executing the bytecode produced by Compiler.
+// It is an alternative to the tree-walking Interpreter and accepts the same
+// resolved programs.
+class VM final
+{
+public:
+    VM();
+    ~VM() = default;
+
+    void interpret(ArenaList<stmt::Stmt*> stmts);
+
+    inline bool error() const { return m_bHadRuntimeError; }
+
+    // Defines 'function' as a global
+    void defineNative(Ref<NativeFunction> function);
+
+    // Wraps and defines the C++ function 'F', see makeNative
+    template <auto F>
+    inline void defineNative(const char* name)
+    {
+        defineNative(makeNative<F>(name));
+    }
+
+    // Slot of the global variable 'name', allocated on first use. Globals
+    // are addressed by slot in the bytecode, the compiler reports slots
+    // past its 16 bit operands.
+    size_t globalSlot(Symbol name);
+
+    inline size_t globalCount() const { return m_globals.size(); }
+
+private:
+    // The script runs in a frame of its own, on top of the calls
+    static constexpr size_t FRAMES_MAX = MAX_CALL_DEPTH + 1;
+    static constexpr size_t STACK_MAX = 64 * 1024;
+
+    struct CallFrame {
+        vm::Closure* pClosure;
+        const uint8_t* ip;
+        Value* pSlots;
+    };
+
+    struct Global {
+        Symbol name;
+        Value value;
+        bool bDefined;
+        // Defined by defineNative, a script may declare it once more
+        bool bNative;
+    };
+
+    // Runs until the call depth drops back to exitDepth
+    bool run(size_t exitDepth);
+
+    bool call(vm::Closure* pClosure, size_t argc);
+    bool callValue(const Value& callee, size_t argc);
+    bool invoke(Symbol name, size_t argc);
+    bool invokeFromClass(vm::Class* pKlass, Symbol name, size_t argc);
+    bool bindMethod(vm::Class* pKlass, Symbol name);
+    bool instantiate(vm::Class* pKlass, size_t argc);
+
+    Ref<vm::Upvalue> captureUpvalue(Value* pLocal);
+    void closeUpvalues(Value* pLast);
+
+    void runtimeError(const std::string& msg);
+    void resetStack();
+
+    inline void push(const Value& value)
+    {
+        *m_pStackTop++ = value;
+    }
+
+    inline Value pop()
+    {
+        return std::move(*--m_pStackTop);
+    }
+
+    // Pops the slots above 'pTop', releasing the references they hold
+    inline void popTo(Value* pTop)
+    {
+        while (m_pStackTop != pTop) {
+            if ((--m_pStackTop)->isObject()) {
+                *m_pStackTop = nullptr;
+            }
+        }
+    }
+
+    inline Value& peek(size_t distance)
+    {
+        return m_pStackTop[-1 - static_cast<ptrdiff_t>(distance)];
+    }
+
+private:
+    bool m_bHadRuntimeError;
+    std::vector<Value> m_stack;
+    Value* m_pStackTop;
+    std::vector<CallFrame> m_frames;
+    size_t m_frameCount;
+    Ref<vm::Upvalue> m_pOpenUpvalues;
+    std::vector<Global> m_globals;
+    std::unordered_map<Symbol, size_t> m_globalSlots;
+    const Symbol m_initSymbol;
+};
+
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef NEX_VM_OBJECT_HPP
+#define NEX_VM_OBJECT_HPP
+
+#include "nex_chunk.hpp"
+#include "nex_heap.hpp"
+#include "nex_symbol.hpp"
+#include "nex_value.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Heap objects created by the bytecode VM. They mirror NexFunction, NexClass
+// and NexInstance but reference compiled chunks instead of the AST.
+namespace nex::vm {
+
+// A compiled function body
+class Function final : public Object
+{
+public:
+    explicit Function(const std::string& name)
+        : m_name(name)
+        , m_arity(0)
+        , m_upvalueCount(0)
+        , m_maxSlots(0)
+        , m_chunk()
+    {}
+
+    virtual ~Function() = default;
+
+    std::string m_name;
+    size_t m_arity;
+    size_t m_upvalueCount;
+    // Stack slots a call uses at most, from the callee's slot on
+    size_t m_maxSlots;
+    Chunk m_chunk;
+};
+
+// A variable captured by a closure. While the variable is still on the VM
+// stack the upvalue is open and points at its slot, when the slot goes away
+// the value is moved into the upvalue itself.
+class Upvalue final : public HeapObject
+{
+public:
+    explicit Upvalue(Value* pSlot)
+        : m_pLocation(pSlot)
+        , m_closed()
+        , m_pNext(nullptr)
+    {}
+
+    virtual ~Upvalue() = default;
+
+    // An open upvalue's slot belongs to the VM stack
+    inline void trace(Tracer& tracer) override
+    {
+        tracer.visit(m_closed);
+        tracer.visit(m_pNext);
+    }
+
+    inline void clear() override
+    {
+        m_closed = nullptr;
+        m_pNext = nullptr;
+    }
+
+    Value* m_pLocation;
+    Value m_closed;
+    // Next open upvalue, the VM keeps them sorted by stack slot
+    Ref<Upvalue> m_pNext;
+};
+
+class Closure final : public HeapObject
+{
+public:
+    explicit Closure(Ref<Function> function)
+        : m_function(function)
+        , m_upvalues(function->m_upvalueCount)
+    {}
+
+    virtual ~Closure() = default;
+
+    inline void trace(Tracer& tracer) override
+    {
+        tracer.visit(m_function);
+        for (const auto& upvalue : m_upvalues) {
+            tracer.visit(upvalue);
+        }
+    }
+
+    inline void clear() override
+    {
+        m_upvalues.clear();
+    }
+
+    Ref<Function> m_function;
+    std::vector<Ref<Upvalue>> m_upvalues;
+};
+
+class Class final : public HeapObject
+{
+public:
+    explicit Class(const std::string& name)
+        : m_name(name)
+        , m_methods()
+        , m_fieldInit()
+    {}
+
+    virtual ~Class() = default;
+
+    inline void trace(Tracer& tracer) override
+    {
+        for (const auto& [name, method] : m_methods) {
+            (void) name;
+            tracer.visit(method);
+        }
+        tracer.visit(m_fieldInit);
+    }
+
+    inline void clear() override
+    {
+        m_methods.clear();
+        m_fieldInit = nullptr;
+    }
+
+    std::string m_name;
+    std::unordered_map<Symbol, Value> m_methods;
+    // Closure that declares the instance fields, nil for classes without any
+    Value m_fieldInit;
+};
+
+class Instance final : public HeapObject
+{
+public:
+    explicit Instance(Ref<Class> klass)
+        : m_klass(klass)
+        , m_fields()
+    {}
+
+    virtual ~Instance() = default;
+
+    inline void trace(Tracer& tracer) override
+    {
+        tracer.visit(m_klass);
+        for (const auto& [name, field] : m_fields) {
+            (void) name;
+            tracer.visit(field);
+        }
+    }
+
+    inline void clear() override
+    {
+        m_klass = nullptr;
+        m_fields.clear();
+    }
+
+    Ref<Class> m_klass;
+    std::unordered_map<Symbol, Value, std::hash<Symbol>, std::equal_to<Symbol>,
+                       HeapAllocator<std::pair<const Symbol, Value>>> m_fields;
+};
+
+class BoundMethod final : public HeapObject
+{
+public:
+    BoundMethod(const Value& receiver, Ref<Closure> method)
+        : m_receiver(receiver)
+        , m_method(method)
+    {}
+
+    virtual ~BoundMethod() = default;
+
+    inline void trace(Tracer& tracer) override
+    {
+        tracer.visit(m_receiver);
+        tracer.visit(m_method);
+    }
+
+    inline void clear() override
+    {
+        m_receiver = nullptr;
+        m_method = nullptr;
+    }
+
+    Value m_receiver;
+    Ref<Closure> m_method;
+};
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef NEX_TEST_HPP
+#define NEX_TEST_HPP
+
+#include "nex_lexer.hpp"
+#include "nex_parser.hpp"
+#include "nex_resolver.hpp"
+#include "nex_optimizer.hpp"
+#include "nex_interpreter.hpp"
+#include "nex_vm.hpp"
+#include "nex_source.hpp"
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace nex::test {
+
+enum class Engine {
+    INTERPRETER,
+    VM,
+};
+
+// Collects what is written to std::cout while it lives, scripts and the
+// diagnostics of every phase print there
+class CapturedOutput final
+{
+public:
+    CapturedOutput()
+        : m_output()
+        , m_pPrevious(std::cout.rdbuf(m_output.rdbuf()))
+    {}
+
+    ~CapturedOutput()
+    {
+        std::cout.rdbuf(m_pPrevious);
+    }
+
+    CapturedOutput(const CapturedOutput&) = delete;
+    CapturedOutput& operator=(const CapturedOutput&) = delete;
+
+    inline std::string str() const { return m_output.str(); }
+
+private:
+    std::ostringstream m_output;
+    std::streambuf* m_pPrevious;
+};
+
+// Runs 'source' the way nexc runs a file and returns what it printed,
+// errors included. 'setup' is called with the Interpreter or the VM before
+// the program runs, to define natives for instance.
+template <typename Setup>
+inline std::string run(std::string_view source, Engine engine, Setup setup)
+{
+    CapturedOutput output;
+
+    Lexer lex(source);
+    Arena arena;
+    Parser parser(lex, arena);
+    auto stmts = parser.parse();
+    if (lex.error() || parser.error()) {
+        return output.str();
+    }
+
+    Resolver resolver(arena);
+    resolver.resolve(stmts);
+    if (resolver.error()) {
+        return output.str();
+    }
+
+    stmts = Optimizer(arena).optimize(stmts);
+
+    if (engine == Engine::VM) {
+        VM vm;
+        setup(vm);
+        vm.interpret(stmts);
+    }
+    else {
+        auto interp = std::make_shared<Interpreter>();
+        setup(*interp);
+        interp->interpret(stmts);
+    }
+
+    return output.str();
+}
+
+inline std::string run(std::string_view source, Engine engine)
+{
+    return run(source, engine, [](auto&) {});
+}
+
+inline std::string runFile(const std::string& path, Engine engine)
+{
+    SourceFile src(path.c_str());
+    return src.isOpen() ? run(src.text(), engine) : "";
+}
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+#include "catch.hpp"
+#include "nex_test.hpp"
+
+#include <filesystem>
+#include <string>
+
+using namespace nex;
+using namespace nex::test;
+
+namespace {
+
+// Script of 'depth' calls nested in each other, printing 0 from the deepest
+std::string nestedCalls(size_t depth)
+{
+    return "func f(n) { if (n == 0) { ret 0; } ret f(n - 1); }\n"
+           "print(f(" + std::to_string(depth - 1) + "));\n";
+}
+
+}
+
+TEST_CASE("Both engines print the same for every example", "[engine]")
+{
+    size_t examples = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(NEX_EXAMPLES_DIR)) {
+        if (entry.path().extension() != ".nex") {
+            continue;
+        }
+
+        INFO(entry.path().string());
+        auto interpreted = runFile(entry.path().string(), Engine::INTERPRETER);
+        CHECK_FALSE(interpreted.empty());
+        CHECK(interpreted == runFile(entry.path().string(), Engine::VM));
+        examples++;
+    }
+    REQUIRE(examples > 0);
+}
+
+TEST_CASE("A bound method is called after its last reference goes", "[engine]")
+{
+    const char* source =
+        "class A { func m(x) { ret x; } }\n"
+        "func get(o) { ret o.m; }\n"
+        "print(get(A())(5));\n";
+
+    CHECK(run(source, Engine::INTERPRETER) == "5\n");
+    CHECK(run(source, Engine::VM) == "5\n");
+}
+
+TEST_CASE("Calls nest up to the call depth limit", "[engine]")
+{
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(nestedCalls(MAX_CALL_DEPTH), engine) == "0\n");
+        CHECK_THAT(run(nestedCalls(MAX_CALL_DEPTH + 1), engine),
+                   Catch::Contains("Stack overflow."));
+    }
+}
+
+TEST_CASE("Runaway recursion is a runtime error", "[engine]")
+{
+    const char* functions =
+        "func f(n) { ret f(n + 1); }\n"
+        "f(0);\n";
+    const char* methods =
+        "class C { func m(n) { ret this.m(n + 1); } }\n"
+        "C().m(0);\n";
+    const char* fields =
+        "class A { let next = A(); }\n"
+        "A();\n";
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK_THAT(run(functions, engine), Catch::Contains("Stack overflow."));
+        CHECK_THAT(run(methods, engine), Catch::Contains("Stack overflow."));
+        CHECK_THAT(run(fields, engine), Catch::Contains("Stack overflow."));
+    }
+}
+
+TEST_CASE("Both engines evaluate comma expressions the same", "[engine]")
+{
+    const char* globals =
+        "let a = 5;\n"
+        "let b = 7;\n"
+        "print((a, b));\n";
+    const char* locals =
+        "func f(x) { ret (x, x + 1); }\n"
+        "print(f(3));\n";
+    const char* assigns =
+        "let a = 1;\n"
+        "func f() { let b = 2; ret (a = a + 1, b = b + a, b); }\n"
+        "print(f());\n"
+        "print(a);\n";
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(globals, engine) == "7\n");
+        CHECK(run(locals, engine) == "4\n");
+        CHECK(run(assigns, engine) == "4\n2\n");
+    }
+}
+
+TEST_CASE("Calls past the end of the value stack are a runtime error", "[engine]")
+{
+    // Frames of 200 locals fill the stack in about 320 calls, the deepest
+    // one then pushes the 255 arguments of another call
+    std::string params;
+    std::string args;
+    for (size_t idx = 0; idx < 255; idx++) {
+        params += (idx ? ", p" : "p") + std::to_string(idx);
+        args += idx ? ", 1" : "1";
+    }
+    std::string locals;
+    for (size_t idx = 0; idx < 200; idx++) {
+        locals += "let l" + std::to_string(idx) + " = n;\n";
+    }
+
+    auto source = "func wide(" + params + ") { ret p254; }\n"
+                  "func deep(n) {\n" + locals +
+                  "    if (n == 0) { ret wide(" + args + "); }\n"
+                  "    ret deep(n - 1);\n"
+                  "}\n";
+
+    for (size_t depth = 300; depth < 340; depth++) {
+        INFO("depth " << depth);
+        auto script = source + "print(deep(" + std::to_string(depth) + "));\n";
+        for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+            auto output = run(script, engine);
+            CHECK((output == "1\n" || output.find("Stack overflow.") != std::string::npos));
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#include "catch.hpp"
+#include "nex_test.hpp"
+
+#include "nex_heap.hpp"
+
+using namespace nex;
+using namespace nex::test;
+
+TEST_CASE("The collector frees the cycles a script leaves", "[heap]")
+{
+    const char* source =
+        "class Node {\n"
+        "    let self;\n"
+        "    func init() { this.self = this; }\n"
+        "}\n"
+        "let i = 0;\n"
+        "while (i < 100) {\n"
+        "    Node();\n"
+        "    i = i + 1;\n"
+        "}\n"
+        "print(i);\n";
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        Heap::collect();
+        auto collected = Heap::stats().objectsCollected;
+        auto live = Heap::stats().objectsLive;
+
+        CHECK(run(source, engine) == "100\n");
+        Heap::collect();
+
+        CHECK(Heap::stats().objectsCollected - collected >= 100);
+        CHECK(Heap::stats().objectsLive <= live);
+    }
+}
@@ -0,0 +1,80 @@
+#include "catch.hpp"
+#include "nex_test.hpp"
+
+#include "nex_inline_cache.hpp"
+
+#include <string>
+
+using namespace nex;
+using namespace nex::test;
+
+TEST_CASE("A call site sees more shapes than its cache holds", "[cache]")
+{
+    // One class per shape, 'v' at a different offset in each and 'name' a
+    // method in some and a field holding a function in the others
+    std::string source;
+    std::string expected;
+    const size_t shapes = InlineCache::CAPACITY + 2;
+    for (size_t idx = 0; idx < shapes; idx++) {
+        auto id = std::to_string(idx);
+        source += "class C" + id + " {\n";
+        for (size_t pad = 0; pad < idx; pad++) {
+            source += "    let p" + std::to_string(pad) + " = 0;\n";
+        }
+        source += "    let v = " + id + ";\n";
+        if (idx % 2) {
+            source += "    let name = nil;\n"
+                      "    func init() { this.name = this.tag; }\n"
+                      "    func tag() { ret \"field " + id + "\"; }\n";
+        }
+        else {
+            source += "    func name() { ret \"method " + id + "\"; }\n";
+        }
+        source += "}\n";
+        expected += (idx % 2 ? "field " : "method ") + id + "\n" + id + "\n";
+    }
+
+    source += "func visit(o) { print(o.name()); print(o.v); }\n"
+              "let round = 0;\n"
+              "while (round < 3) {\n";
+    for (size_t idx = 0; idx < shapes; idx++) {
+        source += "    visit(C" + std::to_string(idx) + "());\n";
+    }
+    source += "    round = round + 1;\n"
+              "}\n";
+
+    std::string rounds = expected + expected + expected;
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(source, engine) == rounds);
+    }
+}
+
+TEST_CASE("A filled call site reads fields of a new shape", "[cache]")
+{
+    // B declares 'x' after another field and C declares a field named
+    // after the method A's instances cached
+    const char* source =
+        "class A { let x = 1; func m() { ret \"A.m\"; } }\n"
+        "class B extends A { let y = 2; let x = 3; }\n"
+        "class C extends A {\n"
+        "    let m = nil;\n"
+        "    func init() { this.m = this.f; }\n"
+        "    func f() { ret \"C.f\"; }\n"
+        "}\n"
+        "func getX(o) { ret o.x; }\n"
+        "func callM(o) { ret o.m(); }\n"
+        "let a = A();\n"
+        "print(getX(a));\n"
+        "print(callM(a));\n"
+        "a.x = 5;\n"
+        "print(getX(a));\n"
+        "print(getX(B()));\n"
+        "print(callM(B()));\n"
+        "print(callM(C()));\n"
+        "print(getX(a));\n"
+        "print(callM(a));\n";
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(source, engine) == "1\nA.m\n5\n3\nA.m\nC.f\n5\nA.m\n");
+    }
+}
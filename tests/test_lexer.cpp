@@ -0,0 +1,91 @@
+#include "catch.hpp"
+#include "nex_test.hpp"
+
+#include "nex_string.hpp"
+
+#include <string>
+#include <string_view>
+
+using namespace nex;
+using namespace nex::test;
+
+// The lexer scans runs of whitespace, comments and strings 16 bytes at a
+// time, the runs here end on each side of those blocks
+
+TEST_CASE("Whitespace runs of any length are skipped", "[lexer]")
+{
+    for (size_t length = 0; length <= 48; length++) {
+        // Every third byte a newline
+        std::string source;
+        size_t newlines = 0;
+        for (size_t idx = 0; idx < length; idx++) {
+            source += idx % 3 == 2 ? '\n' : (idx % 2 ? '\t' : ' ');
+            newlines += source.back() == '\n';
+        }
+        source += "name";
+
+        INFO("length " << length);
+        Lexer lex(source);
+        auto token = lex.next();
+        CHECK(token.m_type == IDENTIFIER);
+        CHECK(token.m_lexeme == "name");
+        CHECK(token.m_line == static_cast<int>(1 + newlines));
+        CHECK(lex.next().m_type == END_OF_FILE);
+    }
+}
+
+TEST_CASE("Comments of any length run to the end of the line", "[lexer]")
+{
+    for (size_t length = 0; length <= 48; length++) {
+        auto source = "//" + std::string(length, 'c') + "\nname";
+
+        INFO("length " << length);
+        Lexer lex(source);
+        auto token = lex.next();
+        CHECK(token.m_type == IDENTIFIER);
+        CHECK(token.m_line == 2);
+    }
+}
+
+TEST_CASE("Strings of any length keep their text and count their lines", "[lexer]")
+{
+    for (size_t length = 0; length <= 48; length++) {
+        std::string text;
+        for (size_t idx = 0; idx < length; idx++) {
+            text += idx % 5 == 4 ? '\n' : 's';
+        }
+        auto source = "\"" + text + "\" name";
+
+        INFO("length " << length);
+        Lexer lex(source);
+        auto token = lex.next();
+        REQUIRE(token.m_type == STRING);
+        CHECK(token.m_literal.asString()->str() == text);
+        CHECK(token.m_line == static_cast<int>(1 + length / 5));
+        CHECK(lex.next().m_type == IDENTIFIER);
+        CHECK_FALSE(lex.error());
+    }
+}
+
+TEST_CASE("An unterminated string is an error", "[lexer]")
+{
+    for (size_t length = 0; length <= 48; length++) {
+        // The closing quote is past the end of the view, the lexer must not
+        // read up to it
+        auto buffer = "\"" + std::string(length, 's') + "\"";
+        std::string_view source(buffer.data(), buffer.size() - 1);
+
+        INFO("length " << length);
+        CapturedOutput output;
+        Lexer lex(source);
+        CHECK(lex.next().m_type == END_OF_FILE);
+        CHECK(lex.error());
+        CHECK_THAT(output.str(), Catch::Contains("Unterminated string."));
+    }
+}
+
+TEST_CASE("An unterminated string reports a single error", "[lexer]")
+{
+    auto output = run("print(\"abc", Engine::INTERPRETER);
+    CHECK(output == "[line 1] Error : Unterminated string.\n");
+}
@@ -0,0 +1,167 @@
+#include "catch.hpp"
+#include "nex_test.hpp"
+
+#include "nex_native.hpp"
+#include "nex_runtime.hpp"
+
+#include <string>
+
+using namespace nex;
+using namespace nex::test;
+
+namespace {
+
+std::string repeat(const std::string& text, double count, bool bSpaced)
+{
+    std::string result;
+    for (int idx = 0; idx < static_cast<int>(count); idx++) {
+        if (bSpaced && idx) {
+            result += " ";
+        }
+        result += text;
+    }
+    return result;
+}
+
+void ignore(Value value)
+{
+    (void) value;
+}
+
+// Defines the natives above on either engine
+auto defineNatives = [](auto& engine) {
+    engine.template defineNative<repeat>("repeat");
+    engine.template defineNative<ignore>("ignore");
+};
+
+}
+
+CATCH_TRANSLATE_EXCEPTION(const NativeError& e)
+{
+    return e.msg();
+}
+
+TEST_CASE("A native takes its arity and types from its signature", "[native]")
+{
+    auto native = makeNative<repeat>("repeat");
+    CHECK(native->arity() == 3);
+    CHECK(native->name() == "repeat");
+
+    Value args[] = { std::string("ab"), 3.0, true };
+    auto result = native->call(nullptr, Arguments(args, 3));
+    REQUIRE(result.isString());
+    CHECK(result.asString()->str() == "ab ab ab");
+
+    CHECK(makeNative<ignore>("ignore")->call(nullptr, Arguments(args, 1)).isNil());
+}
+
+TEST_CASE("A native rejects arguments of the wrong type", "[native]")
+{
+    auto native = makeNative<repeat>("repeat");
+
+    Value args[] = { std::string("ab"), std::string("3"), true };
+    CHECK_THROWS_WITH(native->call(nullptr, Arguments(args, 3)),
+                      "'repeat' expected a number as argument 2 but got string.");
+}
+
+TEST_CASE("Both engines report native arity and type errors", "[native]")
+{
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run("print(repeat(\"ab\", 2, false));", engine, defineNatives) == "abab\n");
+        CHECK(run("print(ignore(nil));", engine, defineNatives) == "nil\n");
+
+        CHECK_THAT(run("repeat(\"ab\", 2);", engine, defineNatives),
+                   Catch::Contains("'repeat' expected 3 arguments but got 2."));
+        CHECK_THAT(run("repeat(\"ab\", 2, 1);", engine, defineNatives),
+                   Catch::Contains("'repeat' expected a bool as argument 3 but got number."));
+        CHECK_THAT(run("sqrt(\"4\");", engine),
+                   Catch::Contains("'sqrt' expected a number as argument 1 but got string."));
+    }
+}
+
+TEST_CASE("The math natives compute on both engines", "[native]")
+{
+    const char* source =
+        "print(sqrt(16));\n"
+        "print(pow(2, 10));\n"
+        "print(floor(2.5) + ceil(2.5));\n"
+        "print(abs(0 - 3));\n"
+        "print(min(4, 7) + max(4, 7));\n"
+        "print(exp(0) + log(1) + sin(0) + cos(0));\n";
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(source, engine) == "4\n1024\n5\n3\n11\n2\n");
+    }
+}
+
+TEST_CASE("A seed gives a repeatable random sequence", "[native]")
+{
+    const char* source =
+        "seed(42);\n"
+        "let a = random();\n"
+        "let b = random();\n"
+        "print(a != b);\n"
+        "print(a >= 0 and a < 1 and b >= 0 and b < 1);\n"
+        "seed(42);\n"
+        "print(a == random() and b == random());\n"
+        "print(a);\n";
+
+    auto interpreted = run(source, Engine::INTERPRETER);
+    CHECK_THAT(interpreted, Catch::StartsWith("true\ntrue\ntrue\n"));
+    CHECK(interpreted == run(source, Engine::VM));
+}
+
+TEST_CASE("Any number seeds the random generator", "[native]")
+{
+    // NaN, infinities and numbers past the range of an integer
+    const char* source =
+        "seed(sqrt(0 - 1));\n"
+        "print(random() < 1);\n"
+        "seed(exp(1000));\n"
+        "print(random() < 1);\n"
+        "seed(log(0));\n"
+        "print(random() < 1);\n"
+        "seed(pow(10, 300));\n"
+        "print(random() < 1);\n";
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(source, engine) == "true\ntrue\ntrue\ntrue\n");
+    }
+}
+
+TEST_CASE("The monotonic clocks never go backwards", "[native]")
+{
+    size_t backwards = 0;
+    auto ns = runtime::clockNanos();
+    auto us = runtime::clockMicros();
+    auto cycles = runtime::clockCycles();
+    for (size_t idx = 0; idx < 10000; idx++) {
+        auto nextNs = runtime::clockNanos();
+        auto nextUs = runtime::clockMicros();
+        auto nextCycles = runtime::clockCycles();
+        backwards += nextNs < ns || nextUs < us || nextCycles < cycles;
+        ns = nextNs;
+        us = nextUs;
+        cycles = nextCycles;
+    }
+    CHECK(backwards == 0);
+
+    const char* source =
+        "let ok = true;\n"
+        "let ns = clock_ns();\n"
+        "let us = clock_us();\n"
+        "let cycles = clock_cycles();\n"
+        "let i = 0;\n"
+        "while (i < 1000) {\n"
+        "    ok = ok and clock_ns() >= ns and clock_us() >= us and clock_cycles() >= cycles;\n"
+        "    ns = clock_ns();\n"
+        "    us = clock_us();\n"
+        "    cycles = clock_cycles();\n"
+        "    i = i + 1;\n"
+        "}\n"
+        "print(ok);\n";
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(source, engine) == "true\n");
+    }
+}
@@ -0,0 +1,118 @@
+#include "catch.hpp"
+#include "nex_test.hpp"
+
+#include <string>
+
+using namespace nex;
+using namespace nex::test;
+
+namespace {
+
+// The statements of 'source' once resolved and optimized
+class Program final
+{
+public:
+    explicit Program(const std::string& source)
+        : m_source(source)
+        , m_arena()
+        , m_stmts()
+    {
+        CapturedOutput output;
+        Lexer lex(m_source);
+        Parser parser(lex, m_arena);
+        auto stmts = parser.parse();
+        REQUIRE_FALSE((lex.error() || parser.error()));
+
+        Resolver resolver(m_arena);
+        resolver.resolve(stmts);
+        REQUIRE_FALSE(resolver.error());
+
+        m_stmts = Optimizer(m_arena).optimize(stmts);
+    }
+
+    inline ArenaList<stmt::Stmt*> stmts() const { return m_stmts; }
+
+    // The expression printed by the statement at 'idx'
+    inline expr::Expr* printed(size_t idx) const
+    {
+        auto pPrint = dynamic_cast<stmt::Print*>(m_stmts[idx]);
+        REQUIRE(pPrint);
+        return pPrint->m_e;
+    }
+
+private:
+    std::string m_source;
+    Arena m_arena;
+    ArenaList<stmt::Stmt*> m_stmts;
+};
+
+const expr::Literal* asLiteral(expr::Expr* e)
+{
+    return dynamic_cast<const expr::Literal*>(e);
+}
+
+}
+
+TEST_CASE("Arithmetic on literals is folded", "[optimizer]")
+{
+    Program program("print((1 + 2) * 3 - 4 / 2);");
+
+    auto pLiteral = asLiteral(program.printed(0));
+    REQUIRE(pLiteral);
+    CHECK(pLiteral->m_value.asNumber() == 7);
+}
+
+TEST_CASE("Concatenation of string literals is folded", "[optimizer]")
+{
+    Program program("print(\"con\" + \"cat\" + \"enated\");");
+
+    auto pLiteral = asLiteral(program.printed(0));
+    REQUIRE(pLiteral);
+    REQUIRE(pLiteral->m_value.isString());
+    CHECK(pLiteral->m_value.asString()->str() == "concatenated");
+}
+
+TEST_CASE("A branch that never runs is pruned", "[optimizer]")
+{
+    const char* source =
+        "if (false) { print(1); }\n"
+        "if (1 > 2) { print(2); } else { print(3); }\n"
+        "print(4);\n";
+    Program program(source);
+
+    for (auto s : program.stmts()) {
+        CHECK_FALSE(dynamic_cast<stmt::If*>(s));
+    }
+    CHECK(program.stmts().size() == 2);
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(source, engine) == "3\n4\n");
+    }
+}
+
+TEST_CASE("Division by zero is left to fail at run time", "[optimizer]")
+{
+    const char* source = "print(1 / 0);";
+    Program program(source);
+
+    CHECK_FALSE(asLiteral(program.printed(0)));
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK_THAT(run(source, engine), Catch::Contains("Division by zero"));
+    }
+}
+
+TEST_CASE("Variables are never folded", "[optimizer]")
+{
+    const char* source =
+        "let a = 1;\n"
+        "a = 5;\n"
+        "print(a + 2);\n";
+    Program program(source);
+
+    CHECK_FALSE(asLiteral(program.printed(2)));
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(source, engine) == "7\n");
+    }
+}
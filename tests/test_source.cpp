@@ -0,0 +1,78 @@
+#include "catch.hpp"
+#include "nex_test.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace nex;
+using namespace nex::test;
+
+namespace {
+
+// A file under the temporary directory, removed when the test ends
+class TempFile final
+{
+public:
+    TempFile(const std::string& name, const std::string& contents)
+        : m_path((std::filesystem::temp_directory_path() / name).string())
+    {
+        std::ofstream(m_path, std::ios::binary) << contents;
+    }
+
+    ~TempFile()
+    {
+        std::filesystem::remove(m_path);
+    }
+
+    inline const std::string& path() const { return m_path; }
+
+private:
+    std::string m_path;
+};
+
+}
+
+TEST_CASE("A regular file is read whole", "[source]")
+{
+    for (size_t length : { 1, 15, 16, 17, 4096 }) {
+        std::string contents(length, 'x');
+        TempFile file("nex_test_source.nex", contents);
+
+        INFO("length " << length);
+        SourceFile src(file.path().c_str());
+        REQUIRE(src.isOpen());
+        CHECK(src.text() == contents);
+    }
+}
+
+TEST_CASE("An empty file is an empty program", "[source]")
+{
+    TempFile file("nex_test_empty.nex", "");
+
+    SourceFile src(file.path().c_str());
+    REQUIRE(src.isOpen());
+    CHECK(src.text().empty());
+
+    CHECK(runFile(file.path(), Engine::INTERPRETER).empty());
+    CHECK(runFile(file.path(), Engine::VM).empty());
+}
+
+TEST_CASE("A missing file is not open", "[source]")
+{
+    auto path = std::filesystem::temp_directory_path() / "nex_test_missing.nex";
+    std::filesystem::remove(path);
+
+    SourceFile src(path.string().c_str());
+    CHECK_FALSE(src.isOpen());
+}
+
+TEST_CASE("A file that cannot be read is not open", "[source]")
+{
+    // A directory opens but fails to read
+    auto path = std::filesystem::temp_directory_path();
+
+    SourceFile src(path.string().c_str());
+    CHECK_FALSE(src.isOpen());
+    CHECK(src.text().empty());
+}
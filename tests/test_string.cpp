@@ -0,0 +1,94 @@
+#include "catch.hpp"
+#include "nex_test.hpp"
+
+#include "nex_string.hpp"
+#include "nex_symbol.hpp"
+
+#include <functional>
+#include <string>
+
+using namespace nex;
+using namespace nex::test;
+
+namespace {
+
+// 'text' concatenated 'count' times, one concatenation at a time
+Ref<NexString> build(const std::string& text, size_t count)
+{
+    auto piece = make_ref<NexString>(text);
+    auto result = make_ref<NexString>("");
+    for (size_t idx = 0; idx < count; idx++) {
+        result = NexString::concat(result.get(), piece.get());
+    }
+    return result;
+}
+
+std::string repeated(const std::string& text, size_t count)
+{
+    std::string result;
+    for (size_t idx = 0; idx < count; idx++) {
+        result += text;
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("A rope equals the flat string with the same characters", "[string]")
+{
+    // Long enough to be a rope and not copied at each step
+    auto rope = build("0123456789", 50);
+    auto flat = make_ref<NexString>(repeated("0123456789", 50));
+
+    CHECK(Value(rope.get()) == Value(flat.get()));
+    CHECK(Value(flat.get()) == Value(rope.get()));
+    CHECK_FALSE(Value(build("0123456789", 49).get()) == Value(flat.get()));
+
+    // Hashed and interned by its characters
+    CHECK(std::hash<std::string>{}(rope->str()) == std::hash<std::string>{}(flat->str()));
+    CHECK(SymbolTable::intern(rope->str()) == SymbolTable::intern(flat->str()));
+    CHECK(Value(rope.get()) == Value(SymbolTable::intern(flat->str())));
+}
+
+TEST_CASE("Concatenations of any length keep their characters", "[string]")
+{
+    // Short results are copied, longer ones make rope nodes
+    for (size_t count : { 1, 63, 64, 65, 100, 1000 }) {
+        INFO("count " << count);
+        auto rope = build("ab", count);
+        CHECK(rope->size() == 2 * count);
+        CHECK(rope->str() == repeated("ab", count));
+        CHECK(rope->size() == rope->str().size());
+    }
+}
+
+TEST_CASE("A rope built in a long loop flattens and releases", "[string]")
+{
+    // Deep enough to overflow the C++ stack if walked recursively
+    auto rope = build("x", 200000);
+    CHECK(rope->size() == 200000);
+    CHECK(rope->str() == std::string(200000, 'x'));
+
+    auto unread = build("y", 200000);
+    CHECK(unread->size() == 200000);
+}
+
+TEST_CASE("Both engines build strings with + in a loop", "[string]")
+{
+    const char* source =
+        "let s = \"\";\n"
+        "let t = \"\";\n"
+        "let i = 0;\n"
+        "while (i < 5000) {\n"
+        "    s = s + \"ab\";\n"
+        "    t = t + \"a\" + \"b\";\n"
+        "    i = i + 1;\n"
+        "}\n"
+        "print(s == t);\n"
+        "print(s + \"!\" == t + \"!\");\n"
+        "print(s == t + \"a\");\n";
+
+    for (auto engine : { Engine::INTERPRETER, Engine::VM }) {
+        CHECK(run(source, engine) == "true\ntrue\nfalse\n");
+    }
+}